@@ -1,74 +1,896 @@
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
 #include <math.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <threads.h>
+#include <unistd.h>
 
 #include "headers/canvas.h"
+#include "headers/qoi.h"
 
-canvas* canvas_init(canvas *c, uint16_t w, uint16_t h) {
+#if defined(__SSE2__)
+# include <immintrin.h>
+#endif
+
+// Emit the external definitions of the inline functions.
+extern canvas* canvas_new(uint32_t w, uint32_t h);
+extern bool canvas_raster_size(uint32_t w, uint32_t h, size_t* size);
+
+canvas* canvas_init(canvas *c, uint32_t w, uint32_t h) {
 	if (c) {
 		c->height = h;
 		c->width = w;
+		c->flags = 0;
 	}
 	return c;
 }
 
-canvas* write_pixel(canvas* c, uint16_t x, uint16_t y, col3* colour) {
+#define TILE_PIXELS (CANVAS_TILE * CANVAS_TILE)
+
+/**
+ * tiles_across - number of tiles spanning one row of a tiled canvas.
+ */
+static
+inline
+size_t tiles_across(canvas const* c) {
+	return ((size_t)c->width + CANVAS_TILE - 1) / CANVAS_TILE;
+}
+
+/**
+ * canvas_row - returns the first pixel of scanline `y`, counted from the top
+ * of the image regardless of the storage order. Not valid for tiled canvases.
+ */
+static
+inline
+col3* canvas_row(canvas const* c, uint32_t y) {
+	size_t row = c->flags & CANVAS_BOTTOM_UP ? c->height - 1u - y : y;
+	return (col3*)&c->pixels[row * c->width];
+}
+
+/**
+ * canvas_index - maps the (x, y) position onto an index into `pixels`.
+ */
+static
+inline
+size_t canvas_index(canvas const* c, uint32_t x, uint32_t y) {
+	if (c->flags & CANVAS_TILED) {
+		size_t tile = (y / CANVAS_TILE) * tiles_across(c) + x / CANVAS_TILE;
+		return tile * TILE_PIXELS + (y % CANVAS_TILE) * CANVAS_TILE + x % CANVAS_TILE;
+	}
+	return canvas_row(c, y) - c->pixels + x;
+}
+
+/**
+ * linear_row - returns scanline `y` as a contiguous run of pixels. Tiled
+ * canvases are gathered into `tmp`, which must hold `width` pixels, one
+ * tile-wide run at a time.
+ */
+static
+col3 const* linear_row(canvas const* c, uint32_t y, col3* restrict tmp) {
+	if (!(c->flags & CANVAS_TILED))
+		return canvas_row(c, y);
+
+	col3 const* src = &c->pixels[(y / CANVAS_TILE) * tiles_across(c) * TILE_PIXELS
+		+ (y % CANVAS_TILE) * CANVAS_TILE];
+	for (uint32_t x = 0; x < c->width; x += CANVAS_TILE, src += TILE_PIXELS) {
+		uint32_t n = c->width - x < CANVAS_TILE ? c->width - x : CANVAS_TILE;
+		memcpy(tmp + x, src, n * sizeof(col3));
+	}
+	return tmp;
+}
+
+canvas* write_pixel(canvas* c, uint32_t x, uint32_t y, col3* colour) {
 	if (c && colour) {
 		if (x < c->width && y < c->height)
-			c->pixels[(y * c->width) + x] = *colour;
+			c->pixels[canvas_index(c, x, y)] = *colour;
 		return c;
 	}
 	return nullptr;
 }
 
-col3 const* pixel_at(canvas const* c, uint16_t x, uint16_t y) {
+col3 const* pixel_at(canvas const* c, uint32_t x, uint32_t y) {
 	if (c && x < c->width && y < c->height)
-		return &c->pixels[(y * c->width) + x];
+		return &c->pixels[canvas_index(c, x, y)];
 	return nullptr;
 }
 
+canvas* canvas_new_tiled(uint32_t w, uint32_t h) {
+	// Partial tiles on the right and bottom edges are stored in full.
+	uint32_t pw = w % CANVAS_TILE ? w + (CANVAS_TILE - w % CANVAS_TILE) : w;
+	uint32_t ph = h % CANVAS_TILE ? h + (CANVAS_TILE - h % CANVAS_TILE) : h;
+	size_t size;
+	if (pw < w || ph < h || !canvas_raster_size(pw, ph, &size)
+			|| ckd_add(&size, size, offsetof(canvas, pixels))) {
+		errno = EOVERFLOW;
+		return nullptr;
+	}
+	if (size < sizeof(canvas))
+		size = sizeof(canvas);
+	canvas* c = canvas_init(calloc(1, size), w, h);
+	if (c)
+		c->flags = CANVAS_TILED;
+	return c;
+}
+
+/**
+ * mapped_header_size - size of the PFM header of a mapped canvas. It spans
+ * exactly one page so that the raster starts at a mappable file offset.
+ */
+static
+size_t mapped_header_size(void) {
+	long page = sysconf(_SC_PAGESIZE);
+	return page > 0 ? (size_t)page : 4096;
+}
+
+canvas* canvas_new_mapped(uint32_t w, uint32_t h, char const* path) {
+	if (!path) {
+		errno = EINVAL;
+		return nullptr;
+	}
+	size_t page = mapped_header_size();
+	size_t raster, total;
+	if (!canvas_raster_size(w, h, &raster) || ckd_add(&total, raster, page)
+			|| (off_t)total < 0 || (size_t)(off_t)total != total) {
+		errno = EOVERFLOW;
+		return nullptr;
+	}
+
+	// PFM header: the scale line carries the byte order and is padded with
+	// trailing zeros (still the same number) up to the page boundary.
+	char* header = malloc(page);
+	if (!header)
+		return nullptr;
+	bool little = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+	int len = snprintf(header, page, "PF\n%" PRIu32 " %" PRIu32 "\n%s1.", w, h, little ? "-" : "");
+	memset(header + len, '0', page - len - 1);
+	header[page - 1] = '\n';
+
+	int fd = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (fd < 0) {
+		free(header);
+		return nullptr;
+	}
+	bool ok = ftruncate(fd, (off_t)total) == 0
+		&& pwrite(fd, header, page, 0) == (ssize_t)page;
+	free(header);
+
+	// The page in front of the raster is private memory holding the canvas
+	// fields; the file's raster is mapped over the rest so that `pixels`
+	// aliases it directly.
+	uint8_t* base = MAP_FAILED;
+	if (ok)
+		base = mmap(nullptr, total, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (base != MAP_FAILED && raster
+			&& mmap(base + page, raster, PROT_READ | PROT_WRITE,
+				MAP_SHARED | MAP_FIXED, fd, (off_t)page) == MAP_FAILED) {
+		munmap(base, total);
+		base = MAP_FAILED;
+	}
+	int err = errno;
+	close(fd);
+	if (base == MAP_FAILED) {
+		unlink(path);
+		errno = err;
+		return nullptr;
+	}
+
+	canvas* c = canvas_init((canvas*)(base + page - offsetof(canvas, pixels)), w, h);
+	c->flags = CANVAS_MAPPED | CANVAS_BOTTOM_UP;
+	return c;
+}
+
+bool canvas_sync(canvas const* c) {
+	if (!c || !(c->flags & CANVAS_MAPPED))
+		return c != nullptr;
+	size_t raster = sizeof(col3) * (size_t)c->width * c->height;
+	return !raster || msync((void*)c->pixels, raster, MS_SYNC) == 0;
+}
+
+void canvas_unmap(canvas* c) {
+	if (c) {
+		size_t page = mapped_header_size();
+		size_t raster = sizeof(col3) * (size_t)c->width * c->height;
+		munmap((uint8_t*)c + offsetof(canvas, pixels) - page, page + raster);
+	}
+}
+
 static
 float clamp(float const x) {
-	float tmp = x < 0 ? 0: x;
+	float tmp = x > 0 ? x: 0; // Also maps NAN to 0.
 	return tmp > MAX_COL_VAL ? MAX_COL_VAL : tmp;
 }
 
+/**
+ * quantize - maps a colour channel onto the integer range [0, MAX_COL_VAL]
+ * using the same rounding as the P3 output.
+ */
 static
-void write_colour(FILE* fp, col3 const* pixel_colour) {
-	if (fp && pixel_colour) {
-		float r = ceilf(pixel_colour->red * MAX_COL_VAL);
-		float g = ceilf(pixel_colour->green * MAX_COL_VAL);
-		float b = ceilf(pixel_colour->blue * MAX_COL_VAL);
+uint8_t quantize(float const x) {
+	return (uint8_t)clamp(ceilf(x * MAX_COL_VAL));
+}
 
-		r = clamp(r);
-		g = clamp(g);
-		b = clamp(b);
+#if defined(__SSE2__)
+/**
+ * quantize4 - vector form of `quantize` for four channels. The value is
+ * clamped before rounding up, which gives the same integer as rounding up
+ * first. `_mm_max_ps` returns its second operand for NAN, so NAN maps to 0
+ * exactly like `clamp`.
+ */
+static
+inline
+__m128i quantize4(__m128 x) {
+	__m128 v = _mm_mul_ps(x, _mm_set1_ps(MAX_COL_VAL));
+	v = _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(MAX_COL_VAL));
+	__m128i t = _mm_cvttps_epi32(v);
+	__m128 below = _mm_cmplt_ps(_mm_cvtepi32_ps(t), v);
+	return _mm_sub_epi32(t, _mm_castps_si128(below)); // below is 0 or -1.
+}
+#endif
+
+#if defined(__AVX2__)
+static
+inline
+__m256i quantize8(__m256 x) {
+	__m256 v = _mm256_mul_ps(x, _mm256_set1_ps(MAX_COL_VAL));
+	v = _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(MAX_COL_VAL));
+	__m256i t = _mm256_cvttps_epi32(v);
+	__m256 below = _mm256_cmp_ps(_mm256_cvtepi32_ps(t), v, _CMP_LT_OQ);
+	return _mm256_sub_epi32(t, _mm256_castps_si256(below));
+}
+#endif
 
-		fprintf(fp, "%g %g %g\n", r, g, b);
+void col3_quantize(col3 const* restrict src, size_t n, uint8_t* restrict dst) {
+	static_assert(sizeof(col3) == 3 * sizeof(float), "col3 must be tightly packed");
+	// Every channel is quantized the same way, so the pixels are processed
+	// as one flat stream of floats that maps one-to-one onto output bytes.
+	float const* f = &src->red;
+	size_t len = 3 * n;
+	size_t i = 0;
+#if defined(__AVX2__)
+	__m256i const order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+	for (; i + 32 <= len; i += 32) {
+		__m256i a = quantize8(_mm256_loadu_ps(f + i));
+		__m256i b = quantize8(_mm256_loadu_ps(f + i + 8));
+		__m256i c = quantize8(_mm256_loadu_ps(f + i + 16));
+		__m256i d = quantize8(_mm256_loadu_ps(f + i + 24));
+		// The packs work per 128-bit lane; the permute restores the order.
+		__m256i bytes = _mm256_packus_epi16(_mm256_packs_epi32(a, b), _mm256_packs_epi32(c, d));
+		_mm256_storeu_si256((__m256i*)(dst + i), _mm256_permutevar8x32_epi32(bytes, order));
+	}
+#endif
+#if defined(__SSE2__)
+	for (; i + 16 <= len; i += 16) {
+		__m128i a = quantize4(_mm_loadu_ps(f + i));
+		__m128i b = quantize4(_mm_loadu_ps(f + i + 4));
+		__m128i c = quantize4(_mm_loadu_ps(f + i + 8));
+		__m128i d = quantize4(_mm_loadu_ps(f + i + 12));
+		__m128i bytes = _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+		_mm_storeu_si128((__m128i*)(dst + i), bytes);
 	}
+#endif
+	for (; i < len; i++)
+		dst[i] = quantize(f[i]);
 }
 
-char* canvas_2_ppm(canvas *c) {
-	char* filename = nullptr;
-	if (c) {
-		FILE* fp = fopen("image.ppm", "wb");
-		if (!fp) {
-			perror("Unable to open `image.ppm`");
-			return filename;
+#define HEADER_MAX 32 // Longest header any of the formats emit.
+#define P3_PIXEL_MAX 12 // "255 255 255\n"
+#define EXPORT_CHUNK (1u << 20) // Bytes handed to the OS per write.
+#define IOV_BATCH 64 // Buffers gathered per writev; well below any IOV_MAX.
+#define QOI_STRIPE_PIXELS (1u << 16) // Pixels per independently encoded stripe.
+
+/**
+ * format_header - writes the header of a `w` by `h` image in `fmt` to `out`.
+ * @Returns: length of the header in bytes.
+ */
+static
+size_t format_header(uint32_t w, uint32_t h, img_fmt fmt, char out[static HEADER_MAX]) {
+	if (fmt == IMG_PFM) {
+		// A negative scale marks the raster as little-endian.
+		bool little = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+		return snprintf(out, HEADER_MAX, "PF\n%" PRIu32 " %" PRIu32 "\n%s\n", w, h, little ? "-1.0" : "1.0");
+	}
+	char const* magic = fmt == IMG_P3 ? "P3" : "P6";
+	return snprintf(out, HEADER_MAX, "%s\n%" PRIu32 " %" PRIu32 "\n%d\n", magic, w, h, MAX_COL_VAL);
+}
+
+/**
+ * format_p3 - formats `n` quantized channels as plain text, three to a line.
+ * When `out` is null only the length is computed.
+ * @Returns: number of characters (that would be) written.
+ */
+static
+size_t format_p3(uint8_t const* rgb, size_t n, char* out) {
+	size_t len = 0;
+	for (size_t i = 0; i < n; i++) {
+		unsigned v = rgb[i];
+		char digits[3];
+		unsigned d = 0;
+		do {
+			digits[d++] = '0' + v % 10;
+			v /= 10;
+		} while (v);
+		if (out) {
+			while (d)
+				out[len++] = digits[--d];
+			out[len++] = i % 3 == 2 ? '\n' : ' ';
+		} else {
+			len += d + 1;
 		}
+	}
+	return len;
+}
+
+/**
+ * row_bytes - upper bound on the encoded size of one scanline.
+ */
+static
+size_t row_bytes(canvas const* c, img_fmt fmt) {
+	size_t per_pixel = fmt == IMG_P3 ? P3_PIXEL_MAX
+		: fmt == IMG_PFM ? sizeof(col3)
+		: fmt == IMG_QOI ? QOI_PIXEL_MAX
+		: 3;
+	return per_pixel * (size_t)c->width;
+}
+
+/**
+ * scratch_size - bytes of scratch space `encode_rows` needs for `c`: one
+ * linear scanline for tiled canvases, followed by one quantized scanline.
+ * The size is a multiple of 16 so that data placed after it stays aligned.
+ */
+static
+size_t scratch_size(canvas const* c) {
+	size_t size = 3 * (size_t)c->width + 1;
+	if (c->flags & CANVAS_TILED)
+		size += sizeof(col3) * (size_t)c->width;
+	return (size + 15) & ~(size_t)15;
+}
+
+/**
+ * encode_rows - encodes the scanlines [`y0`, `y1`) into `out`. Scanlines
+ * are counted in file order, which for PFM starts at the bottom of the image.
+ * @scratch: `scratch_size(c)` bytes, aligned for `col3`.
+ * @Returns: number of bytes written.
+ */
+static
+size_t encode_rows(canvas const* c, img_fmt fmt, uint32_t y0, uint32_t y1,
+		uint8_t* restrict out, uint8_t* restrict scratch) {
+	if (fmt == IMG_PFM) {
+		// The raster is the pixels as-is; only the row order may differ.
+		size_t row = sizeof(col3) * (size_t)c->width;
+		if (c->flags & CANVAS_BOTTOM_UP) {
+			memcpy(out, canvas_row(c, c->height - 1u - y0), (y1 - y0) * row);
+			return (y1 - y0) * row;
+		}
+		for (uint32_t y = y0; y < y1; y++, out += row)
+			memcpy(out, linear_row(c, c->height - 1u - y, (col3*)scratch), row);
+		return (y1 - y0) * row;
+	}
+
+	if (fmt != IMG_P3 && !(c->flags & (CANVAS_BOTTOM_UP | CANVAS_TILED))) {
+		size_t n = (size_t)(y1 - y0) * c->width;
+		col3_quantize(canvas_row(c, y0), n, out);
+		return 3 * n;
+	}
+
+	col3* linear = (col3*)scratch;
+	uint8_t* rgb = c->flags & CANVAS_TILED ? scratch + sizeof(col3) * (size_t)c->width : scratch;
+	size_t len = 0;
+	for (uint32_t y = y0; y < y1; y++) {
+		col3 const* row = linear_row(c, y, linear);
+		if (fmt != IMG_P3) {
+			col3_quantize(row, c->width, out + len);
+			len += 3 * (size_t)c->width;
+			continue;
+		}
+		col3_quantize(row, c->width, rgb);
+		len += format_p3(rgb, 3 * (size_t)c->width, (char*)out + len);
+	}
+	return len;
+}
+
+/**
+ * write_all - writes `len` bytes to `fd`, retrying short and interrupted
+ * writes.
+ */
+static
+bool write_all(int fd, void const* buf, size_t len) {
+	uint8_t const* p = buf;
+	while (len) {
+		ssize_t n = write(fd, p, len);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		p += n;
+		len -= (size_t)n;
+	}
+	return true;
+}
+
+/**
+ * writev_all - writes the `n` buffers in `iov` to `fd` in order, retrying
+ * short and interrupted writes. `iov` is consumed in the process.
+ */
+static
+bool writev_all(int fd, struct iovec* iov, unsigned n) {
+	while (n) {
+		ssize_t done = writev(fd, iov, (int)n);
+		if (done < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		for (; n && (size_t)done >= iov->iov_len; n--, iov++)
+			done -= (ssize_t)iov->iov_len;
+		if (n) {
+			iov->iov_base = (uint8_t*)iov->iov_base + done;
+			iov->iov_len -= (size_t)done;
+		}
+	}
+	return true;
+}
 
-		filename = "image.ppm";
-		fprintf(fp, "P3\n%u %u\n%d\n", c->width, c->height, MAX_COL_VAL);
-		for (uint16_t i = 0; i < c->height; ++i) {
-			fprintf(stderr, "\rScanlines remaining: %u ", (c->height - i));
-			fflush(stderr);
-			for (uint16_t j = 0; j < c->width; ++j) {
-				write_colour(fp, pixel_at(c, j, i));
+/**
+ * pwrite_all - writes `len` bytes to `fd` at offset `off`, retrying short
+ * and interrupted writes.
+ */
+static
+bool pwrite_all(int fd, void const* buf, size_t len, off_t off) {
+	uint8_t const* p = buf;
+	while (len) {
+		ssize_t n = pwrite(fd, p, len, off);
+		if (n < 0) {
+			if (errno == EINTR)
+				continue;
+			return false;
+		}
+		p += n;
+		off += n;
+		len -= (size_t)n;
+	}
+	return true;
+}
+
+/**
+ * qoi_stripe - a run of whole scanlines of a QOI image, encoded on its own.
+ */
+typedef struct qoi_stripe qoi_stripe;
+struct qoi_stripe {
+	uint32_t y0;
+	uint32_t y1;
+	uint8_t* out;
+	size_t len;
+};
+
+typedef struct qoi_job qoi_job;
+struct qoi_job {
+	canvas const* c;
+	qoi_stripe* stripes;
+	size_t count;
+	atomic_size_t next; // Next stripe to hand out.
+	atomic_bool failed;
+};
+
+static
+bool encode_qoi_stripe(canvas const* c, qoi_stripe* s) {
+	uint8_t* scratch = malloc(scratch_size(c));
+	s->out = malloc(QOI_PIXEL_MAX * (size_t)(s->y1 - s->y0) * c->width + 1);
+	if (!scratch || !s->out) {
+		free(scratch);
+		return false;
+	}
+	uint8_t* rgb = c->flags & CANVAS_TILED ? scratch + sizeof(col3) * (size_t)c->width : scratch;
+
+	// Seed the encoder with the last pixel of the previous stripe.
+	qoi_enc e;
+	uint8_t prev[3];
+	if (s->y0)
+		col3_quantize(pixel_at(c, c->width - 1, s->y0 - 1), 1, prev);
+	qoi_enc_init(&e, s->y0 ? prev : nullptr);
+
+	s->len = 0;
+	for (uint32_t y = s->y0; y < s->y1; y++) {
+		col3_quantize(linear_row(c, y, (col3*)scratch), c->width, rgb);
+		s->len += qoi_encode(&e, rgb, c->width, s->out + s->len);
+	}
+	s->len += qoi_flush(&e, s->out + s->len);
+	free(scratch);
+	return true;
+}
+
+static
+int qoi_worker(void* arg) {
+	qoi_job* job = arg;
+	size_t i;
+	while ((i = atomic_fetch_add(&job->next, 1)) < job->count)
+		if (!encode_qoi_stripe(job->c, &job->stripes[i]))
+			atomic_store(&job->failed, true);
+	return 0;
+}
+
+static
+void free_qoi_stripes(qoi_stripe* stripes, size_t count) {
+	for (size_t i = 0; stripes && i < count; i++)
+		free(stripes[i].out);
+	free(stripes);
+}
+
+/**
+ * encode_qoi - encodes the raster of `c` as horizontal stripes that are
+ * compressed independently, on up to one thread per online CPU, and are
+ * meant to be concatenated. Stripe boundaries depend only on the image size,
+ * so the output is the same on every machine.
+ * @count: number of stripes (output).
+ * @Returns: the stripes, released with `free_qoi_stripes`. Otherwise, null.
+ */
+static
+qoi_stripe* encode_qoi(canvas const* c, size_t* count) {
+	uint32_t rows = c->width && c->width < QOI_STRIPE_PIXELS ? QOI_STRIPE_PIXELS / c->width : 1;
+	size_t n = c->width ? ((size_t)c->height + rows - 1) / rows : 0;
+	qoi_stripe* stripes = calloc(n ? n : 1, sizeof *stripes);
+	if (!stripes)
+		return nullptr;
+	for (size_t i = 0; i < n; i++) {
+		stripes[i].y0 = (uint32_t)(i * rows);
+		stripes[i].y1 = c->height - stripes[i].y0 < rows ? c->height : stripes[i].y0 + rows;
+	}
+
+	qoi_job job = { .c = c, .stripes = stripes, .count = n };
+	atomic_init(&job.next, 0);
+	atomic_init(&job.failed, false);
+
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t helpers = cpus > 1 ? (size_t)cpus - 1 : 0;
+	if (helpers >= n)
+		helpers = n ? n - 1 : 0;
+	thrd_t* pool = helpers ? malloc(helpers * sizeof *pool) : nullptr;
+	size_t started = 0;
+	while (pool && started < helpers && thrd_create(&pool[started], qoi_worker, &job) == thrd_success)
+		++started;
+	qoi_worker(&job);
+	for (size_t i = 0; i < started; i++)
+		thrd_join(pool[i], nullptr);
+	free(pool);
+
+	if (atomic_load(&job.failed)) {
+		free_qoi_stripes(stripes, n);
+		return nullptr;
+	}
+	*count = n;
+	return stripes;
+}
+
+/**
+ * export_qoi - encodes `c` as QOI and writes it either to `fd` (gathering
+ * the stripes with `writev`) or, when `fd` is negative, to `buf`.
+ * @Returns: number of bytes written, or 0 on failure.
+ */
+static
+size_t export_qoi(canvas const* c, int fd, void* buf, size_t cap) {
+	size_t count;
+	qoi_stripe* stripes = encode_qoi(c, &count);
+	if (!stripes)
+		return 0;
+
+	uint8_t header[QOI_HEADER_SIZE], end[QOI_END_SIZE];
+	qoi_header(c->width, c->height, header);
+	qoi_end(end);
+	size_t size = sizeof header + sizeof end;
+	for (size_t i = 0; i < count; i++)
+		size += stripes[i].len;
+
+	bool ok = true;
+	if (fd < 0) {
+		ok = buf && cap >= size;
+		if (ok) {
+			uint8_t* p = buf;
+			memcpy(p, header, sizeof header);
+			p += sizeof header;
+			for (size_t i = 0; i < count; p += stripes[i++].len)
+				memcpy(p, stripes[i].out, stripes[i].len);
+			memcpy(p, end, sizeof end);
+		}
+	} else {
+		struct iovec iov[IOV_BATCH];
+		unsigned n = 0;
+		iov[n++] = (struct iovec){ .iov_base = header, .iov_len = sizeof header };
+		for (size_t i = 0; ok && i < count; i++) {
+			iov[n++] = (struct iovec){ .iov_base = stripes[i].out, .iov_len = stripes[i].len };
+			if (n == IOV_BATCH) {
+				ok = writev_all(fd, iov, n);
+				n = 0;
 			}
 		}
-		fclose(fp);
+		iov[n++] = (struct iovec){ .iov_base = end, .iov_len = sizeof end };
+		ok = ok && writev_all(fd, iov, n);
+	}
+	free_qoi_stripes(stripes, count);
+	return ok ? size : 0;
+}
+
+size_t canvas_export_size(canvas const* c, img_fmt fmt) {
+	if (!c)
+		return 0;
+	char header[HEADER_MAX];
+	if (fmt == IMG_QOI)
+		return QOI_HEADER_SIZE + row_bytes(c, fmt) * c->height + QOI_END_SIZE;
+	size_t size = format_header(c->width, c->height, fmt, header);
+	if (fmt != IMG_P3)
+		return size + row_bytes(c, fmt) * c->height;
+
+	uint8_t* scratch = malloc(scratch_size(c));
+	if (!scratch)
+		return 0;
+	uint8_t* rgb = c->flags & CANVAS_TILED ? scratch + sizeof(col3) * (size_t)c->width : scratch;
+	for (uint32_t y = 0; y < c->height; y++) {
+		col3_quantize(linear_row(c, y, (col3*)scratch), c->width, rgb);
+		size += format_p3(rgb, 3 * (size_t)c->width, nullptr);
+	}
+	free(scratch);
+	return size;
+}
+
+size_t canvas_export_mem(canvas const* c, img_fmt fmt, void* buf, size_t cap) {
+	if (c && fmt == IMG_QOI)
+		return export_qoi(c, -1, buf, cap);
+	size_t size = canvas_export_size(c, fmt);
+	if (!size || !buf || cap < size)
+		return 0;
+
+	uint8_t* scratch = malloc(scratch_size(c));
+	if (!scratch)
+		return 0;
+
+	char header[HEADER_MAX];
+	size_t len = format_header(c->width, c->height, fmt, header);
+	memcpy(buf, header, len);
+	len += encode_rows(c, fmt, 0, c->height, (uint8_t*)buf + len, scratch);
+	free(scratch);
+	return len;
+}
+
+/**
+ * export_pfm_fd - writes a PFM straight from the canvas memory: the kernel
+ * gathers the header and the scanlines (in reverse for top-down storage)
+ * with `writev`, so the raster is never copied in user space.
+ */
+static
+bool export_pfm_fd(canvas const* c, int fd) {
+	char header[HEADER_MAX];
+	size_t row = sizeof(col3) * (size_t)c->width;
+	struct iovec iov[IOV_BATCH];
+	iov[0] = (struct iovec){ .iov_base = header, .iov_len = format_header(c->width, c->height, IMG_PFM, header) };
+	unsigned n = 1;
+
+	if (c->flags & CANVAS_BOTTOM_UP) {
+		iov[n++] = (struct iovec){ .iov_base = (void*)c->pixels, .iov_len = row * c->height };
+		return writev_all(fd, iov, n);
+	}
+	for (uint32_t y = c->height; y-- > 0;) {
+		iov[n++] = (struct iovec){ .iov_base = canvas_row(c, y), .iov_len = row };
+		if (n == IOV_BATCH) {
+			if (!writev_all(fd, iov, n))
+				return false;
+			n = 0;
+		}
+	}
+	return writev_all(fd, iov, n);
+}
+
+bool canvas_export_fd(canvas const* c, img_fmt fmt, int fd) {
+	if (!c || fd < 0)
+		return false;
+	if (fmt == IMG_PFM && !(c->flags & CANVAS_TILED))
+		return export_pfm_fd(c, fd);
+	if (fmt == IMG_QOI)
+		return export_qoi(c, fd, nullptr, 0) != 0;
+
+	// Scanlines are encoded into a bounded chunk that is flushed with one
+	// write, so large canvases never need a second full-size copy.
+	size_t per_row = row_bytes(c, fmt);
+	size_t rows = per_row ? EXPORT_CHUNK / per_row : 1;
+	if (rows == 0)
+		rows = 1;
+	uint8_t* scratch = malloc(scratch_size(c) + HEADER_MAX + rows * per_row);
+	if (!scratch)
+		return false;
+	uint8_t* chunk = scratch + scratch_size(c);
+
+	size_t len = format_header(c->width, c->height, fmt, (char*)chunk);
+	bool ok = true;
+	for (uint32_t y = 0; ok && y < c->height; y += rows) {
+		uint32_t end = c->height - y < rows ? c->height : y + rows;
+		len += encode_rows(c, fmt, y, end, chunk + len, scratch);
+		ok = write_all(fd, chunk, len);
+		len = 0;
+	}
+	if (ok && len)
+		ok = write_all(fd, chunk, len); // Header of an empty canvas.
+	free(scratch);
+	return ok;
+}
 
-		fprintf(stderr, "\rDONE.                       \n");
+char const* canvas_export_file(canvas const* c, img_fmt fmt, char const* path) {
+	if (!c || !path)
+		return nullptr;
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (fd < 0)
+		return nullptr;
+	bool ok = canvas_export_fd(c, fmt, fd);
+	if (close(fd) != 0)
+		ok = false;
+	return ok ? path : nullptr;
+}
+
+char* canvas_2_ppm(canvas* c, img_fmt fmt) {
+	char* filename = nullptr;
+	if (fmt != IMG_P6 && fmt != IMG_P3) {
+		errno = EINVAL;
+		return filename;
+	}
+	if (c) {
+		if (canvas_export_file(c, fmt, "image.ppm"))
+			filename = "image.ppm";
+		else
+			perror("Unable to write `image.ppm`");
 	}
 	return filename;
 }
 
+struct canvas_stream {
+	int fd;
+	bool owns_fd;
+	bool ok; // Cleared by the first failed write.
+	img_fmt fmt;
+	off_t start; // Offset of the header, for formats written in place.
+	size_t header_len;
+	uint32_t height; // Height of the whole image.
+	uint32_t next_row; // Image scanline the current band starts at.
+	uint32_t band_rows;
+	uint8_t* chunk; // Encoded band, written with a single call.
+	uint8_t* scratch;
+	canvas* band;
+	qoi_enc qoi; // Carried from band to band.
+};
+
+canvas_stream* canvas_stream_open(uint32_t w, uint32_t h, uint32_t band_rows, img_fmt fmt, int fd) {
+	if (fd < 0 || band_rows == 0) {
+		errno = EINVAL;
+		return nullptr;
+	}
+	if (band_rows > h)
+		band_rows = h ? h : 1;
+
+	canvas_stream* s = calloc(1, sizeof *s);
+	if (!s)
+		return nullptr;
+	*s = (canvas_stream){
+		.fd = fd,
+		.ok = true,
+		.fmt = fmt,
+		.height = h,
+		.band_rows = band_rows,
+		.band = canvas_new(w, band_rows),
+	};
+	if (!s->band)
+		goto fail;
+
+	// A QOI band may start by closing the run left open by the previous one.
+	size_t encoded;
+	if (ckd_mul(&encoded, row_bytes(s->band, fmt), band_rows)
+			|| ckd_add(&encoded, encoded, scratch_size(s->band) + (fmt == IMG_QOI))) {
+		errno = EOVERFLOW;
+		goto fail;
+	}
+	if (!(s->scratch = malloc(encoded)))
+		goto fail;
+	s->chunk = s->scratch + scratch_size(s->band);
+
+	if (fmt == IMG_PFM && (s->start = lseek(fd, 0, SEEK_CUR)) < 0)
+		goto fail;
+
+	char header[HEADER_MAX];
+	if (fmt == IMG_QOI) {
+		qoi_header(w, h, (uint8_t*)header);
+		qoi_enc_init(&s->qoi, nullptr);
+		s->header_len = QOI_HEADER_SIZE;
+	} else {
+		s->header_len = format_header(w, h, fmt, header);
+	}
+	s->ok = write_all(fd, header, s->header_len);
+	if (!s->ok)
+		goto fail;
+	return s;
+
+fail:
+	canvas_delete(&s->band);
+	free(s->scratch);
+	free(s);
+	return nullptr;
+}
+
+canvas_stream* canvas_stream_open_file(uint32_t w, uint32_t h, uint32_t band_rows, img_fmt fmt, char const* path) {
+	if (!path) {
+		errno = EINVAL;
+		return nullptr;
+	}
+	int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (fd < 0)
+		return nullptr;
+	canvas_stream* s = canvas_stream_open(w, h, band_rows, fmt, fd);
+	if (!s) {
+		int err = errno;
+		close(fd);
+		errno = err;
+		return nullptr;
+	}
+	s->owns_fd = true;
+	return s;
+}
+
+canvas* canvas_stream_band(canvas_stream* s, uint32_t* y0) {
+	if (!s || !s->ok || s->next_row >= s->height)
+		return nullptr;
+	if (y0)
+		*y0 = s->next_row;
+	return s->band;
+}
+
+bool canvas_stream_commit(canvas_stream* s) {
+	if (!s || !s->ok || s->next_row >= s->height)
+		return false;
+
+	canvas* band = s->band;
+	size_t len = 0;
+	if (s->fmt == IMG_QOI) {
+		for (uint32_t y = 0; y < band->height; y++) {
+			col3_quantize(canvas_row(band, y), band->width, s->scratch);
+			len += qoi_encode(&s->qoi, s->scratch, band->width, s->chunk + len);
+		}
+	} else {
+		len = encode_rows(band, s->fmt, 0, band->height, s->chunk, s->scratch);
+	}
+	if (s->fmt == IMG_PFM) {
+		// PFM runs bottom-up, so each band is placed at its final offset.
+		size_t below = s->height - s->next_row - band->height;
+		off_t off = s->start + (off_t)(s->header_len + below * row_bytes(band, IMG_PFM));
+		s->ok = pwrite_all(s->fd, s->chunk, len, off);
+	} else {
+		s->ok = write_all(s->fd, s->chunk, len);
+	}
+
+	// Recycle the band for the next scanlines.
+	s->next_row += band->height;
+	memset(band->pixels, 0, sizeof(col3) * (size_t)band->width * band->height);
+	if (s->height - s->next_row < band->height)
+		band->height = s->height - s->next_row;
+	return s->ok;
+}
+
+bool canvas_stream_close(canvas_stream** s) {
+	if (!s || !*s)
+		return false;
+	canvas_stream* t = *s;
+	bool ok = t->ok && t->next_row >= t->height;
+	if (ok && t->fmt == IMG_QOI) {
+		uint8_t tail[1 + QOI_END_SIZE];
+		size_t len = qoi_flush(&t->qoi, tail);
+		qoi_end(tail + len);
+		ok = write_all(t->fd, tail, len + QOI_END_SIZE);
+	}
+	if (t->owns_fd && close(t->fd) != 0)
+		ok = false;
+	canvas_delete(&t->band);
+	free(t->scratch);
+	free(t);
+	*s = nullptr;
+	return ok;
+}
@@ -0,0 +1,125 @@
+#include <stdlib.h>
+#include <threads.h>
+
+#include "headers/export_queue.h"
+
+struct export_queue {
+	mtx_t lock;
+	cnd_t pending; // Signalled when a job is queued or the queue stops.
+	cnd_t finished; // Signalled when a job completes.
+	export_job* head;
+	export_job* tail;
+	bool stop;
+	thrd_t writer;
+};
+
+static
+bool run_job(export_job const* job) {
+	if (job->path)
+		return canvas_export_file(job->canvas, job->fmt, job->path) != nullptr;
+	return canvas_export_fd(job->canvas, job->fmt, job->fd);
+}
+
+static
+int writer(void* arg) {
+	export_queue* q = arg;
+	mtx_lock(&q->lock);
+	for (;;) {
+		while (!q->head && !q->stop)
+			cnd_wait(&q->pending, &q->lock);
+		export_job* job = q->head;
+		if (!job)
+			break; // Stopped and drained.
+		q->head = job->next;
+		if (!q->head)
+			q->tail = nullptr;
+
+		mtx_unlock(&q->lock);
+		bool ok = run_job(job);
+		mtx_lock(&q->lock);
+
+		job->ok = ok;
+		job->done = true;
+		cnd_broadcast(&q->finished);
+	}
+	mtx_unlock(&q->lock);
+	return 0;
+}
+
+export_queue* export_queue_new(void) {
+	export_queue* q = calloc(1, sizeof *q);
+	if (!q)
+		return nullptr;
+	if (mtx_init(&q->lock, mtx_plain) != thrd_success)
+		goto no_lock;
+	if (cnd_init(&q->pending) != thrd_success)
+		goto no_pending;
+	if (cnd_init(&q->finished) != thrd_success)
+		goto no_finished;
+	if (thrd_create(&q->writer, writer, q) != thrd_success)
+		goto no_writer;
+	return q;
+
+no_writer:
+	cnd_destroy(&q->finished);
+no_finished:
+	cnd_destroy(&q->pending);
+no_pending:
+	mtx_destroy(&q->lock);
+no_lock:
+	free(q);
+	return nullptr;
+}
+
+bool export_queue_submit(export_queue* q, export_job* job) {
+	if (!job)
+		return false;
+	// A rejected job counts as finished and failed, so that waiting on it
+	// returns at once instead of blocking forever.
+	job->next = nullptr;
+	job->done = true;
+	job->ok = false;
+	if (!q || !job->canvas)
+		return false;
+	mtx_lock(&q->lock);
+	bool ok = !q->stop;
+	if (ok) {
+		job->done = false;
+		if (q->tail)
+			q->tail->next = job;
+		else
+			q->head = job;
+		q->tail = job;
+		cnd_signal(&q->pending);
+	}
+	mtx_unlock(&q->lock);
+	return ok;
+}
+
+bool export_wait(export_queue* q, export_job* job) {
+	if (!q || !job)
+		return false;
+	mtx_lock(&q->lock);
+	while (!job->done)
+		cnd_wait(&q->finished, &q->lock);
+	bool ok = job->ok;
+	mtx_unlock(&q->lock);
+	return ok;
+}
+
+void export_queue_delete(export_queue** q) {
+	if (q && *q) {
+		export_queue* t = *q;
+		mtx_lock(&t->lock);
+		t->stop = true;
+		cnd_signal(&t->pending);
+		mtx_unlock(&t->lock);
+		thrd_join(t->writer, nullptr);
+
+		cnd_destroy(&t->finished);
+		cnd_destroy(&t->pending);
+		mtx_destroy(&t->lock);
+		free(t);
+		*q = nullptr;
+	}
+}
@@ -7,25 +7,80 @@
 # define __gnu_free__(...)
 #endif
 
+#include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
 
+#if __has_include(<stdckdint.h>)
+# include <stdckdint.h>
+#else
+# define ckd_add(r, a, b) __builtin_add_overflow((a), (b), (r))
+# define ckd_mul(r, a, b) __builtin_mul_overflow((a), (b), (r))
+#endif
+
 #include "colour.h"
 
 #define MAX_COL_VAL 255
 
+#define CANVAS_TILE 8 // Side of a tile in a tiled canvas, in pixels.
+
+/**
+ * img_fmt - image encodings understood by the canvas exporters.
+ * @IMG_P6: binary PPM, one byte per channel. This is the default.
+ * @IMG_P3: plain-text PPM, one pixel per line. Slow; meant for debugging.
+ * @IMG_PFM: portable float map. The raster is the `col3` data unchanged, in
+ * native byte order and bottom scanline first; nothing is clamped.
+ * @IMG_QOI: lossless "Quite OK Image" compression of the P6 pixels. Stripes
+ * of scanlines are compressed in parallel and concatenated.
+ */
+typedef enum img_fmt img_fmt;
+enum img_fmt {
+	IMG_P6,
+	IMG_P3,
+	IMG_PFM,
+	IMG_QOI,
+};
+
+/**
+ * canvas_flags - describes how a canvas' pixel storage is laid out.
+ * @CANVAS_MAPPED: `pixels` lives in a shared file mapping, not on the heap.
+ * @CANVAS_BOTTOM_UP: scanlines are stored from the bottom of the image up.
+ * @CANVAS_TILED: `pixels` is a row-major grid of CANVAS_TILE x CANVAS_TILE
+ * tiles, each stored row-major. Edge tiles are padded to full size.
+ */
+enum canvas_flags {
+	CANVAS_MAPPED = 1u << 0,
+	CANVAS_BOTTOM_UP = 1u << 1,
+	CANVAS_TILED = 1u << 2,
+};
+
 typedef struct canvas canvas;
 struct canvas {
-	uint16_t width;
-	uint16_t height;
+	uint32_t width;
+	uint32_t height;
+	uint32_t flags;
 	col3 pixels[];
 };
+
+/**
+ * canvas_raster_size - computes the size in bytes of the pixels of a `w` by
+ * `h` canvas without overflowing.
+ * @w: width of the canvas.
+ * @h: height of the canvas.
+ * @size: pointer to the computed size (output).
+ * @Returns: true if the size is representable. Otherwise, false.
+ */
+inline
+bool canvas_raster_size(uint32_t w, uint32_t h, size_t* size) {
+	return !ckd_mul(size, (size_t)w, (size_t)h) && !ckd_mul(size, *size, sizeof(col3));
+}
 /**
  * canvas_init - initialises a canvas buffer with maximally `w` * `h` pixels.
  * Only use this function on an uninitialised canvas buffer.
  */
-canvas* canvas_init(canvas *c, uint16_t w, uint16_t h);
+canvas* canvas_init(canvas *c, uint32_t w, uint32_t h);
 
 /**
  * write_pixel - writes a pixel to the canvas at the specified (x,y) position.
@@ -35,7 +90,7 @@ canvas* canvas_init(canvas *c, uint16_t w, uint16_t h);
  * @colour: pointer to the pixel colour.
  * @Returns: modified canvas or null.
  */
-canvas* write_pixel(canvas* c, uint16_t x, uint16_t y, col3* colour);
+canvas* write_pixel(canvas* c, uint32_t x, uint32_t y, col3* colour);
 
 /**
  * pixel_at - returns the address of the pixel at the given (x, y) position.
@@ -44,33 +99,194 @@ canvas* write_pixel(canvas* c, uint16_t x, uint16_t y, col3* colour);
  * @y: y-coordinate on the canvas. Goes from top to bottom.
  * @Returns: pixel's address or null.
  */
-col3 const* pixel_at(canvas const* c, uint16_t x, uint16_t y);
+col3 const* pixel_at(canvas const* c, uint32_t x, uint32_t y);
+
+/**
+ * col3_quantize - converts `n` pixels into packed 8-bit RGB triplets. Each
+ * channel is scaled by MAX_COL_VAL, rounded up and clamped to
+ * [0, MAX_COL_VAL]; NAN maps to 0. Uses SSE2/AVX2 lanes when the target
+ * supports them, and the scalar tail produces bit-identical results.
+ * @src: pointer to the first pixel (input).
+ * @n: number of pixels to convert.
+ * @dst: pointer to at least 3 * `n` bytes (output). Must not overlap `src`.
+ */
+void col3_quantize(col3 const* restrict src, size_t n, uint8_t* restrict dst);
+
+/**
+ * canvas_export_size - computes the number of bytes the canvas occupies when
+ * encoded as `fmt`. Use it to size the buffer given to `canvas_export_mem`.
+ * For IMG_QOI this is an upper bound on the compressed size.
+ * @c: pointer to the canvas.
+ * @fmt: image encoding.
+ * @Returns: encoded size in bytes. Otherwise, 0.
+ */
+size_t canvas_export_size(canvas const* c, img_fmt fmt);
+
+/**
+ * canvas_export_mem - encodes the canvas into a caller-owned buffer.
+ * @c: pointer to the canvas.
+ * @fmt: image encoding.
+ * @buf: pointer to the output buffer.
+ * @cap: capacity of `buf` in bytes.
+ * @Returns: number of bytes written. Otherwise, 0 (e.g. if `cap` is smaller
+ * than `canvas_export_size`).
+ */
+size_t canvas_export_mem(canvas const* c, img_fmt fmt, void* buf, size_t cap);
+
+/**
+ * canvas_export_fd - encodes the canvas and writes it to an already-open
+ * file descriptor (a file, pipe or socket). The image is encoded in bounded
+ * chunks, each handed to the OS in a single write. PFM is written straight
+ * from the canvas memory with gathered writes. `fd` is left open.
+ * @c: pointer to the canvas.
+ * @fmt: image encoding.
+ * @fd: file descriptor open for writing.
+ * @Returns: true if the whole image was written. Otherwise, false.
+ */
+bool canvas_export_fd(canvas const* c, img_fmt fmt, int fd);
+
+/**
+ * canvas_export_file - encodes the canvas into the file at `path`, creating
+ * or truncating it.
+ * @c: pointer to the canvas.
+ * @fmt: image encoding.
+ * @path: path of the output file.
+ * @Returns: `path` if the file was written. Otherwise, null with `errno` set.
+ */
+char const* canvas_export_file(canvas const* c, img_fmt fmt, char const* path);
 
 /**
- * canvas_2_ppm - generates a string representation of the canvas
- * that will be written out to a file with the ppm format.
+ * canvas_2_ppm - writes the canvas out to `image.ppm` in the ppm format.
+ * Shorthand for `canvas_export_file(c, fmt, "image.ppm")`.
  * @c: pointer to the canvas.
- * @Returns: string buffer holding the canvas information.
- * Otherwise, null if the string buffer could not be allocated.
+ * @fmt: either `IMG_P6` or `IMG_P3`.
+ * @Returns: name of the written file. Otherwise, null if the file could not
+ * be written, or with `errno` set to EINVAL if `fmt` is not a PPM format.
+ */
+char* canvas_2_ppm(canvas* c, img_fmt fmt);
+
+/**
+ * canvas_new_tiled - creates a canvas whose pixels are grouped into
+ * CANVAS_TILE x CANVAS_TILE tiles, so that a renderer walking the image tile
+ * by tile touches a few contiguous cache lines and pages per tile. The
+ * accessors work unchanged; the exporters convert back to scanline order.
+ * Release it with `canvas_delete`.
+ * @w: width of the canvas.
+ * @h: height of the canvas.
+ * @Returns: pointer to the canvas. Otherwise, null with `errno` set.
+ */
+[[nodiscard("pointer to allocated canvas dropped.")]]
+[[__gnu__::__malloc__]]
+canvas* canvas_new_tiled(uint32_t w, uint32_t h);
+
+/**
+ * canvas_new_mapped - creates a canvas whose pixels live in a shared mapping
+ * of the file at `path`. The file is laid out as a little-endian PFM image
+ * (header followed by the float raster, bottom scanline first), so every
+ * `write_pixel` lands directly in the page cache and the file is a complete
+ * image once the canvas is deleted; no export pass or second copy is needed.
+ * The header is padded to one page so the raster can be mapped in place.
+ * @w: width of the canvas.
+ * @h: height of the canvas.
+ * @path: path of the backing file. It is created or truncated.
+ * @Returns: pointer to the canvas. Otherwise, null with `errno` set
+ * (`EOVERFLOW` if the image cannot be addressed).
+ */
+[[nodiscard("pointer to mapped canvas dropped.")]]
+canvas* canvas_new_mapped(uint32_t w, uint32_t h, char const* path);
+
+/**
+ * canvas_sync - flushes the pixels of a mapped canvas to its backing file.
+ * @c: pointer to a canvas created by `canvas_new_mapped`.
+ * @Returns: true on success (always for heap canvases). Otherwise, false.
+ */
+bool canvas_sync(canvas const* c);
+
+/**
+ * canvas_unmap - releases a canvas created by `canvas_new_mapped`. Prefer
+ * `canvas_delete`, which dispatches here for mapped canvases.
+ */
+void canvas_unmap(canvas* c);
+
+/**
+ * canvas_stream - writes an image band by band, for images that do not fit
+ * in memory. The caller renders a band of scanlines into a small canvas,
+ * commits it (it is quantized and appended to the output) and reuses the
+ * same memory for the next band, so the footprint stays fixed at one band.
+ */
+typedef struct canvas_stream canvas_stream;
+
+/**
+ * canvas_stream_open - starts streaming a `w` by `h` image to `fd`. The
+ * header is written immediately. `fd` is left open by `canvas_stream_close`.
+ * @w: width of the image.
+ * @h: height of the image.
+ * @band_rows: number of scanlines per band.
+ * @fmt: image encoding. PFM stores the bottom scanline first, so its bands
+ * are written in place with `pwrite` and `fd` must be seekable.
+ * @fd: file descriptor open for writing (a file, pipe or socket).
+ * @Returns: pointer to the stream. Otherwise, null with `errno` set.
+ */
+[[nodiscard("pointer to canvas stream dropped.")]]
+canvas_stream* canvas_stream_open(uint32_t w, uint32_t h, uint32_t band_rows, img_fmt fmt, int fd);
+
+/**
+ * canvas_stream_open_file - like `canvas_stream_open`, but creates or
+ * truncates the file at `path`. The file is closed with the stream.
+ */
+[[nodiscard("pointer to canvas stream dropped.")]]
+canvas_stream* canvas_stream_open_file(uint32_t w, uint32_t h, uint32_t band_rows, img_fmt fmt, char const* path);
+
+/**
+ * canvas_stream_band - returns the canvas holding the current band. Its
+ * scanline `y` is scanline `*y0 + y` of the image, and its height is
+ * `band_rows` except possibly for the last band. The band starts out black.
+ * @s: pointer to the stream.
+ * @y0: pointer to the first image scanline of the band (output). May be null.
+ * @Returns: the band, or null once every scanline has been committed.
+ */
+canvas* canvas_stream_band(canvas_stream* s, uint32_t* y0);
+
+/**
+ * canvas_stream_commit - encodes the current band, appends it to the output
+ * and recycles its memory for the next band.
+ * @s: pointer to the stream.
+ * @Returns: true if the band was written. Otherwise, false.
+ */
+bool canvas_stream_commit(canvas_stream* s);
+
+/**
+ * canvas_stream_close - releases the stream and sets `*s` to null.
+ * @s: pointer to the stream pointer.
+ * @Returns: true if every scanline was committed and written. Otherwise,
+ * false; the output is then incomplete.
  */
-char* canvas_2_ppm(canvas* c);
+bool canvas_stream_close(canvas_stream** s);
 
 /**
  * canvas_delete - delete a canvas buffer `c`. The buffer must have been
- * allocated with a call to `canvas_new`.
+ * allocated with a call to `canvas_new`, `canvas_new_mapped` or
+ * `canvas_new_tiled`.
  */
 static
 inline
 void canvas_delete(canvas** c) {
-	free(*c);
-	c = nullptr;
+	if (*c && (*c)->flags & CANVAS_MAPPED)
+		canvas_unmap(*c);
+	else
+		free(*c);
+	*c = nullptr;
 }
 
 [[nodiscard("pointer to allocated canvas dropped.")]]
 [[__gnu__::__malloc__]]
 inline
-canvas* canvas_new(uint16_t w, uint16_t h) {
-	size_t size = offsetof(canvas, pixels) + sizeof(col3[w*h]);
+canvas* canvas_new(uint32_t w, uint32_t h) {
+	size_t size;
+	if (!canvas_raster_size(w, h, &size) || ckd_add(&size, size, offsetof(canvas, pixels))) {
+		errno = EOVERFLOW;
+		return nullptr;
+	}
 	if (size < sizeof(canvas))
 		size = sizeof(canvas);
 	return canvas_init((canvas*)calloc(1, size), w, h);
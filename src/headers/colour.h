@@ -8,6 +8,14 @@ struct col3 {
 	float blue;
 };
 
+/*
+ * col3 stays three packed floats: it is the canvas storage and the PFM
+ * on-disk layout. Arithmetic is done in a four-lane SSE register, with the
+ * fourth lane zero, through the value API below.
+ */
+typedef float float4 __attribute__((vector_size(4 * sizeof(float))));
+
+#define COL3_INLINE [[__gnu__::__always_inline__]] static inline
 
 #define COLOUR(r, g, b) ((col3){ .red=(r), .green=(g), .blue=(b) })
 
@@ -63,4 +71,45 @@ col3* col_hadamard_mul(col3 const* a, col3 const* b, col3* c) {
 	return nullptr;
 }
 
+/**
+ * col3_lanes - widens a colour to a four-lane vector with a zero last lane.
+ * @c: colour (input).
+ * @Returns: <red, green, blue, 0>.
+ */
+COL3_INLINE
+float4 col3_lanes(col3 c) {
+	return (float4){ c.red, c.green, c.blue, 0 };
+}
+
+/**
+ * col3_from_lanes - narrows a four-lane vector back to a colour, dropping
+ * the last lane.
+ * @v: vector (input).
+ * @Returns: <v[0], v[1], v[2]> as a colour.
+ */
+COL3_INLINE
+col3 col3_from_lanes(float4 v) {
+	return (col3){ .red=v[0], .green=v[1], .blue=v[2] };
+}
+
+COL3_INLINE
+col3 col3_add(col3 a, col3 b) {
+	return col3_from_lanes(col3_lanes(a) + col3_lanes(b));
+}
+
+COL3_INLINE
+col3 col3_sub(col3 a, col3 b) {
+	return col3_from_lanes(col3_lanes(a) - col3_lanes(b));
+}
+
+COL3_INLINE
+col3 col3_scale(col3 a, float t) {
+	return col3_from_lanes(col3_lanes(a) * t);
+}
+
+COL3_INLINE
+col3 col3_hadamard(col3 a, col3 b) {
+	return col3_from_lanes(col3_lanes(a) * col3_lanes(b));
+}
+
 #endif
@@ -0,0 +1,76 @@
+#ifndef MY_EXPORT_QUEUE_H
+#define MY_EXPORT_QUEUE_H 1
+
+#include <stdbool.h>
+
+#include "canvas.h"
+
+/**
+ * export_job - a canvas handed to an `export_queue`, and its completion
+ * handle. The job is owned by the caller; it and its canvas must stay alive
+ * and unmodified until `export_wait` has returned for it.
+ * @canvas: pointer to the canvas to export.
+ * @fmt: image encoding.
+ * @path: output file. If null, the image is written to `fd` instead.
+ * @fd: file descriptor open for writing; left open.
+ */
+typedef struct export_job export_job;
+struct export_job {
+	canvas const* canvas;
+	img_fmt fmt;
+	char const* path;
+	int fd;
+
+	// Private; maintained by the queue.
+	export_job* next;
+	bool done;
+	bool ok;
+};
+
+/*
+ * Jobs start out finished and failed, so that `export_wait` on a job that
+ * was never queued returns false at once.
+ */
+#define EXPORT_FILE(c, f, p) ((export_job){ .canvas=(c), .fmt=(f), .path=(p), .fd=-1, .done=true })
+#define EXPORT_FD(c, f, d) ((export_job){ .canvas=(c), .fmt=(f), .fd=(d), .done=true })
+
+/**
+ * export_queue - a background writer thread that exports canvases in
+ * submission order, so that the caller can render the next frame into a
+ * second canvas while the previous one is being encoded and written.
+ */
+typedef struct export_queue export_queue;
+
+/**
+ * export_queue_new - starts a writer thread.
+ * @Returns: pointer to the queue. Otherwise, null.
+ */
+[[nodiscard("pointer to export queue dropped.")]]
+export_queue* export_queue_new(void);
+
+/**
+ * export_queue_submit - queues `job` and returns immediately.
+ * @q: pointer to the queue.
+ * @job: pointer to the job. Must not already be pending.
+ * @Returns: true if the job was queued. Otherwise, false, and the job is
+ * marked as finished and failed.
+ */
+[[nodiscard("rejected export job ignored.")]]
+bool export_queue_submit(export_queue* q, export_job* job);
+
+/**
+ * export_wait - blocks until `job` has been written. Returns at once for a
+ * job that was rejected or never submitted.
+ * @q: pointer to the queue the job was submitted to.
+ * @job: pointer to the job.
+ * @Returns: true if the image was written. Otherwise, false.
+ */
+bool export_wait(export_queue* q, export_job* job);
+
+/**
+ * export_queue_delete - finishes every pending job, stops the writer thread
+ * and releases the queue. `*q` is set to null.
+ */
+void export_queue_delete(export_queue** q);
+
+#endif
@@ -2,7 +2,9 @@
 #define MY_MAT_H 1
 
 #include <stdbool.h>
+#include <stddef.h>
 
+#include "packet.h"
 #include "vec3.h"
 
 /**
@@ -14,12 +16,12 @@ typedef struct mat16 mat16;
 struct mat16 {
 	union {
 		struct {
-			float m00, m01, m02, m03;  // Matrix first row (4-components).
-			float m10, m11, m12, m13;  // Matrix second row (4-components).
-			float m20, m21, m22, m23;  // Matrix third row (4-components).
-			float m30, m31, m32, m33;  // Matrix fourth row (4-components).
+			real m00, m01, m02, m03;  // Matrix first row (4-components).
+			real m10, m11, m12, m13;  // Matrix second row (4-components).
+			real m20, m21, m22, m23;  // Matrix third row (4-components).
+			real m30, m31, m32, m33;  // Matrix fourth row (4-components).
 		};
-		float data[16];
+		real data[16];
 	};
 };
 
@@ -29,11 +31,104 @@ struct mat16 {
 
 #define SCALING(x, y, z) ((mat16){ .m00=(x), .m11=(y), .m22=(z), .m33=1 })
 
-#define RADIANS(deg) (((deg) * M_PI / 180.0))
+#define RADIANS(deg) ((deg) * (real)(M_PI / 180))
 
-#define ROTATION_X(rad) ((mat16){ .m00=1, .m11=cos((rad)), .m12=-sin((rad)), .m21=sin((rad)), .m22=cos((rad)), .m33=1 })
-#define ROTATION_Y(rad) ((mat16){ .m00=cos((rad)), .m02=sin((rad)), .m11=1, .m20=-sin((rad)), .m22=cos((rad)), .m33=1 })
-#define ROTATION_Z(rad) ((mat16){ .m00=cos((rad)), .m01=-sin((rad)), .m10=sin((rad)), .m11=cos((rad)), .m22=1, .m33=1 })
+/**
+ * sincos_pair - the sine and cosine of one angle. Rotation builders take
+ * one of these, so an angle's transcendental functions are evaluated once
+ * and can be reused across several rotations (or frames).
+ */
+typedef struct sincos_pair sincos_pair;
+struct sincos_pair {
+	real s;
+	real c;
+};
+
+/**
+ * sincos_rad - the sine and cosine of `rad`. GCC merges the two calls into
+ * a single sincos, and folds them away entirely for constant angles.
+ * @rad: angle in radians.
+ * @Returns: <sin(rad), cos(rad)>.
+ */
+static
+inline
+sincos_pair sincos_rad(real rad) {
+	return (sincos_pair){ .s=sin(rad), .c=cos(rad) };
+}
+
+/**
+ * sincos_deg - the sine and cosine of a whole number of degrees, from a
+ * compile-time table of sin(0..90 degrees) and the quadrant symmetries. No
+ * transcendental function is called, and right angles are exact.
+ * @deg: angle in degrees, any sign.
+ * @Returns: <sin(deg), cos(deg)>.
+ */
+sincos_pair sincos_deg(int deg);
+
+/**
+ * rotation_x - rotation about the x axis by the angle whose sine and cosine
+ * are `sc`. rotation_y and rotation_z are the same about the y and z axes.
+ * @sc: sine and cosine of the angle.
+ * @out: pointer to a 4x4 matrix (output).
+ * @Returns: `out`.
+ */
+static
+inline
+mat16* rotation_x(sincos_pair sc, mat16* out) {
+	*out = (mat16){ .m00=1, .m11=sc.c, .m12=-sc.s, .m21=sc.s, .m22=sc.c, .m33=1 };
+	return out;
+}
+
+static
+inline
+mat16* rotation_y(sincos_pair sc, mat16* out) {
+	*out = (mat16){ .m00=sc.c, .m02=sc.s, .m11=1, .m20=-sc.s, .m22=sc.c, .m33=1 };
+	return out;
+}
+
+static
+inline
+mat16* rotation_z(sincos_pair sc, mat16* out) {
+	*out = (mat16){ .m00=sc.c, .m01=-sc.s, .m10=sc.s, .m11=sc.c, .m22=1, .m33=1 };
+	return out;
+}
+
+#define ROTATION_X(rad) (*rotation_x(sincos_rad((rad)), (&(mat16){ })))
+#define ROTATION_Y(rad) (*rotation_y(sincos_rad((rad)), (&(mat16){ })))
+#define ROTATION_Z(rad) (*rotation_z(sincos_rad((rad)), (&(mat16){ })))
+
+#define ROTATION_X_DEG(deg) (*rotation_x(sincos_deg((deg)), (&(mat16){ })))
+#define ROTATION_Y_DEG(deg) (*rotation_y(sincos_deg((deg)), (&(mat16){ })))
+#define ROTATION_Z_DEG(deg) (*rotation_z(sincos_deg((deg)), (&(mat16){ })))
+
+/**
+ * quat - quaternion <x, y, z, w> = w + xi + yj + zk, stored in a tuple so
+ * that the tuple operations (add, scale, dot, unit, ...) apply to it.
+ */
+typedef tuple quat;
+
+#define QUAT(a, b, c, d) ((quat){ .x=(a), .y=(b), .z=(c), .w=(d) })
+
+/**
+ * mat12 - Affine transform type (3 x 4 row-major representation.)
+ * The top three rows of a 4x4 matrix whose fourth row is implicitly
+ * <0, 0, 0, 1>, which holds for every transform built from TRANSLATION,
+ * SCALING and ROTATION_*. The left 3x3 block is the linear part and the
+ * last column the translation.
+ */
+typedef struct mat12 mat12;
+struct mat12 {
+	union {
+		struct {
+			real m00, m01, m02, m03;  // Matrix first row (4-components).
+			real m10, m11, m12, m13;  // Matrix second row (4-components).
+			real m20, m21, m22, m23;  // Matrix third row (4-components).
+		};
+		real data[12];
+	};
+};
+
+#define MAT12_IDENTITY ((mat12){ .m00=1, .m11=1, .m22=1 })
 
 /**
  * mat9 - Matrix type (3 x 3 row-major representation.)
@@ -44,11 +139,11 @@ typedef struct mat9 mat9;
 struct mat9 {
 	union {
 		struct {
-			float m00, m01, m02;  // Matrix first row (3-components).
-			float m10, m11, m12;  // Matrix second row (3-components).
-			float m20, m21, m22;  // Matrix third row (3-components).
+			real m00, m01, m02;  // Matrix first row (3-components).
+			real m10, m11, m12;  // Matrix second row (3-components).
+			real m20, m21, m22;  // Matrix third row (3-components).
 		};
-		float data[9];
+		real data[9];
 	};
 };
 
@@ -61,10 +156,10 @@ typedef struct mat4 mat4;
 struct mat4 {
 	union {
 		struct {
-			float m00, m01;  // Matrix first row (2-components).
-			float m10, m11;  // Matrix second row (2-components).
+			real m00, m01;  // Matrix first row (2-components).
+			real m10, m11;  // Matrix second row (2-components).
 		};
-		float data[4];
+		real data[4];
 	};
 };
 
@@ -73,21 +168,21 @@ struct mat4 {
  * @a: pointer to 2x2 matrix.
  * @Returns: determinant of the matrix.
  */
-float mat4_determinant(mat4 const* a);
+real mat4_determinant(mat4 const* a);
 
 /**
  * mat4_determinant - computest the determinant of a 3x3 matrix `a`.
  * @a: pointer to 3x3 matrix.
  * @Returns: determinant of the matrix.
  */
-float mat9_determinant(mat9 const* a);
+real mat9_determinant(mat9 const* a);
 
 /**
  * mat16_determinant - computest the determinant of a 4x4 matrix `a`.
  * @a: pointer to 4x4 matrix.
  * @Returns: determinant of the matrix.
  */
-float mat16_determinant(mat16 const* a);
+real mat16_determinant(mat16 const* a);
 
 #define MAT16_SUBMATRIX(a, r, c) (mat16_submatrix((a), (r), (c), (&(mat9){ })))
 /**
@@ -125,7 +220,7 @@ mat4* mat9_submatrix(mat9 const* a, unsigned r, unsigned c, mat4* out);
  * @c: column of the element of interest. Using 0-indexing.
  * @Returns: The minor of the element at location of interest. NAN, otherwise.
  */
-float mat9_minor(mat9 const* a, unsigned r, unsigned c);
+real mat9_minor(mat9 const* a, unsigned r, unsigned c);
 
 /**
  * mat9_cofactor - computes the cofactor of the element at a[r][c] within the
@@ -135,7 +230,7 @@ float mat9_minor(mat9 const* a, unsigned r, unsigned c);
  * @c: column of the element of interest. Using 0-indexing.
  * @ReturnsL The cofactor of the element at the specified location. NAN, otherwise.
  */
-float mat9_cofactor(mat9 const* a, unsigned r, unsigned c);
+real mat9_cofactor(mat9 const* a, unsigned r, unsigned c);
 
 /**
  * mat16_minor - computes the minor of the element at a[r][c] within the 4x4
@@ -145,7 +240,7 @@ float mat9_cofactor(mat9 const* a, unsigned r, unsigned c);
  * @c: column of the element of interest. Using 0-indexing.
  * @Returns: The minor of the element at location of interest. NAN, otherwise.
  */
-float mat16_minor(mat16 const* a, unsigned r, unsigned c);
+real mat16_minor(mat16 const* a, unsigned r, unsigned c);
 
 /**
  * mat16_cofactor - computes the cofactor of the element at a[r][c] within the
@@ -155,7 +250,7 @@ float mat16_minor(mat16 const* a, unsigned r, unsigned c);
  * @c: column of the element of interest. Using 0-indexing.
  * @ReturnsL The cofactor of the element at the specified location. NAN, otherwise.
  */
-float mat16_cofactor(mat16 const* a, unsigned r, unsigned c);
+real mat16_cofactor(mat16 const* a, unsigned r, unsigned c);
 
 /**
  * mat16_is_equal - tests the equality of two 4x4 matrices. If every
@@ -171,10 +266,11 @@ bool mat16_is_equal(mat16 const* a, mat16 const* b);
 #define MAT16_MUL(a, b) (mat16_mul((a), (b), (&(mat16){ })))
 /**
  * mat16_mul - multiplies two 4x4 matrices: matrix a and matrix b. The result of
- * the operation is stored in the output 4x4 matrix `c`.
+ * the operation is stored in the output 4x4 matrix `c`. Each row of `c` is
+ * built in one vector register from broadcast elements of `a` times rows of `b`.
  * @a: pointer to a 4x4 matrix (first input).
  * @b: pointer to a 4x4 matrix (second input).
- * @c: pointer to a 4x4 matrix (output).
+ * @c: pointer to a 4x4 matrix (output). May alias `a` or `b`.
  * @Returns: matrix c that holds the result of the multiplication. Otherwise, null.
  */
 mat16* mat16_mul(mat16 const* a, mat16 const* b, mat16* c);
@@ -190,6 +286,20 @@ mat16* mat16_mul(mat16 const* a, mat16 const* b, mat16* c);
  */
 tuple* mat16_mul_by_tuple(mat16 const* a, tuple const* b, tuple* out);
 
+/**
+ * mat16_mul_tuple_array - multiplies the 4x4 matrix `a` by each of the `n`
+ * tuples in `in`: out[i] = a * in[i]. The matrix is transposed into column
+ * registers once, after which each tuple costs four broadcasts and four
+ * vector multiply-adds.
+ * @a: pointer to a 4x4 matrix (input).
+ * @in: array of `n` tuples (input).
+ * @n: number of tuples.
+ * @out: array of `n` tuples (output). Must not overlap `in`.
+ * @Returns: `out`. Otherwise, null.
+ */
+tuple* mat16_mul_tuple_array(mat16 const* restrict a, tuple const* restrict in, size_t n,
+		tuple* restrict out);
+
 /**
  * mat16_transpose - transposes a 4x4 matrix `a`. This involves turning the rows
  * of the matrix into the columns and the columns into the rows.
@@ -202,9 +312,147 @@ mat16* mat16_transpose(mat16* a);
 /**
  * mat16_inverse - computes the inverse of a 4x4 matrix `a`. This operation relies
  * on finding the adjoint of the matrix and dividing it by the matrix's determinant.
+ * Both come in closed form from twelve shared 2x2 sub-determinants, six from
+ * the top two rows and six from the bottom two.
  * @a: pointer to a 4x4 matrix (input).
- * @out: pointer to a 4x4 matrix (output).
+ * @out: pointer to a 4x4 matrix (output). May be `a` itself.
  * @Returns: inverse of `a`. Otherwise, null.
  */
 mat16* mat16_inverse(mat16 const* a, mat16* out);
+
+/**
+ * mat16_soa - PACKET_WIDTH 4x4 matrices in structure-of-arrays form:
+ * data[k][i] is element k (row-major, as in mat16.data) of matrix i, so
+ * batch operations work on every matrix at once, one lane each. Heap
+ * arrays must be aligned like the type: aligned_alloc(alignof(mat16_soa), ...).
+ */
+typedef struct mat16_soa mat16_soa;
+struct mat16_soa {
+	real_lanes data[16];
+};
+
+/**
+ * mat16_soa_set - stores a matrix into one lane of a batch.
+ * @a: pointer to the batch (output).
+ * @i: lane, below PACKET_WIDTH.
+ * @m: pointer to a 4x4 matrix (input).
+ * @Returns: `a`. Otherwise, null.
+ */
+mat16_soa* mat16_soa_set(mat16_soa* a, unsigned i, mat16 const* m);
+
+/**
+ * mat16_soa_get - extracts one lane of a batch.
+ * @a: pointer to the batch (input).
+ * @i: lane, below PACKET_WIDTH.
+ * @out: pointer to a 4x4 matrix (output).
+ * @Returns: `out`. Otherwise, null.
+ */
+mat16* mat16_soa_get(mat16_soa const* a, unsigned i, mat16* out);
+
+/**
+ * mat16_soa_determinant - the determinants of every matrix in a batch,
+ * from the same twelve 2x2 minors as `mat16_determinant`.
+ * @a: pointer to the batch (input).
+ * @Returns: determinant of matrix `i` in lane `i`.
+ */
+real_lanes mat16_soa_determinant(mat16_soa const* a);
+
+/**
+ * mat16_soa_inverse - inverts every matrix of a batch at once. Nothing is
+ * printed for singular matrices: their lanes of `out` are zeroed and their
+ * bits in the returned status are clear.
+ * @a: pointer to the batch (input).
+ * @out: pointer to the batch of inverses (output). May be `a` itself.
+ * @Returns: bit `i` set when matrix `i` was invertible.
+ */
+uint32_t mat16_soa_inverse(mat16_soa const* a, mat16_soa* out);
+
+/**
+ * mat16_inverse_batch - inverts `n` batches of matrices, e.g. the instance
+ * transforms of a whole scene.
+ * @a: array of `n` batches (input).
+ * @n: number of batches.
+ * @out: array of `n` batches of inverses (output). May be `a` itself.
+ * @status: array of `n` bitmaps (output): bit `i` of status[j] is set when
+ * matrix `i` of batch `j` was invertible.
+ * @Returns: number of invertible matrices.
+ */
+size_t mat16_inverse_batch(mat16_soa const* a, size_t n, mat16_soa* out, uint32_t* status);
+
+#define MAT16_ROTATION_AXIS(axis, rad) (rotation_axis_angle((axis), (rad), (&(mat16){ })))
+/**
+ * rotation_axis_angle - rotation by `rad` about `axis` (right-handed, as
+ * ROTATION_X/Y/Z), by Rodrigues' formula. The axis need not be unit length.
+ * @axis: pointer to the rotation axis (input).
+ * @rad: angle in radians.
+ * @out: pointer to a 4x4 matrix (output).
+ * @Returns: `out`. Otherwise, null (also for a zero-length axis).
+ */
+mat16* rotation_axis_angle(vec3 const* axis, real rad, mat16* out);
+
+#define MAT16_FROM_QUAT(q) (rotation_quat((q), (&(mat16){ })))
+/**
+ * rotation_quat - the rotation matrix of quaternion `q`. The quaternion is
+ * normalised on the way, so any non-zero multiple of a unit quaternion
+ * gives the same matrix.
+ * @q: pointer to a quaternion (input).
+ * @out: pointer to a 4x4 matrix (output).
+ * @Returns: `out`. Otherwise, null (also for a zero quaternion).
+ */
+mat16* rotation_quat(quat const* q, mat16* out);
+
+#define MAT12_FROM_MAT16(a) (mat12_from_mat16((a), (&(mat12){ })))
+/**
+ * mat12_from_mat16 - copies the top three rows of the 4x4 matrix `a` into
+ * the affine transform `out`. Fails if `a` is not affine, i.e. if its last
+ * row is not <0, 0, 0, 1>.
+ * @a: pointer to a 4x4 matrix (input).
+ * @out: pointer to an affine transform (output).
+ * @Returns: `out`. Otherwise, null.
+ */
+mat12* mat12_from_mat16(mat16 const* a, mat12* out);
+
+#define MAT16_FROM_MAT12(a) (mat16_from_mat12((a), (&(mat16){ })))
+/**
+ * mat16_from_mat12 - expands the affine transform `a` to a 4x4 matrix with
+ * last row <0, 0, 0, 1>.
+ * @a: pointer to an affine transform (input).
+ * @out: pointer to a 4x4 matrix (output).
+ * @Returns: `out`. Otherwise, null.
+ */
+mat16* mat16_from_mat12(mat12 const* a, mat16* out);
+
+#define MAT12_MUL(a, b) (mat12_mul((a), (b), (&(mat12){ })))
+/**
+ * mat12_mul - composes two affine transforms: `c` = `a` * `b`, which
+ * applies `b` first. Costs 36 multiplications against 64 for `mat16_mul`.
+ * @a: pointer to an affine transform (first input).
+ * @b: pointer to an affine transform (second input).
+ * @c: pointer to an affine transform (output). May alias `a` or `b`.
+ * @Returns: `c`. Otherwise, null.
+ */
+mat12* mat12_mul(mat12 const* a, mat12 const* b, mat12* c);
+
+#define MAT12_MUL_TUPLE(a, b) (mat12_mul_by_tuple((a), (b), (&(tuple){ })))
+/**
+ * mat12_mul_by_tuple - applies the affine transform `a` to tuple `b`: the
+ * linear part to <x, y, z> and the translation scaled by w, so points
+ * (w = 1) are translated and vectors (w = 0) are not. w is unchanged.
+ * @a: pointer to an affine transform (first input).
+ * @b: pointer to a tuple (second input).
+ * @out: pointer to a tuple (output). May alias `b`.
+ * @Returns: `out`. Otherwise, null.
+ */
+tuple* mat12_mul_by_tuple(mat12 const* a, tuple const* b, tuple* out);
+
+#define MAT12_INVERSE(a) (mat12_inverse((a), (&(mat12){ })))
+/**
+ * mat12_inverse - inverts the affine transform `a`. The linear part is
+ * inverted as a 3x3 matrix (its adjugate over its determinant) and the
+ * translation becomes -(L^-1 * t).
+ * @a: pointer to an affine transform (input).
+ * @out: pointer to an affine transform (output). May be `a` itself.
+ * @Returns: inverse of `a`. Otherwise, null (also when `a` is singular).
+ */
+mat12* mat12_inverse(mat12 const* a, mat12* out);
 #endif
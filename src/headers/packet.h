@@ -0,0 +1,243 @@
+#ifndef MY_PACKET_H
+#define MY_PACKET_H 1
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ray.h"
+
+/*
+ * Ray packets: PACKET_WIDTH rays stored as structure-of-arrays, one GCC
+ * vector per component, so each operation below works on every lane at
+ * once. The default of 8 lanes fills an AVX-512 register with doubles, or
+ * an AVX register with floats. Build with -DPACKET_WIDTH=16 for 16-wide
+ * float packets on AVX-512.
+ */
+#ifndef PACKET_WIDTH
+# define PACKET_WIDTH 8
+#endif
+
+static_assert((PACKET_WIDTH & (PACKET_WIDTH - 1)) == 0 && PACKET_WIDTH <= 32,
+		"PACKET_WIDTH must be a power of two, at most 32");
+
+/**
+ * real_lanes - one real per lane. Supports the usual arithmetic operators
+ * and subscripting (`l[i]`).
+ */
+typedef real real_lanes __attribute__((vector_size(PACKET_WIDTH * sizeof(real))));
+
+/**
+ * lane_mask - one integer per lane, as wide as real: all ones for a set
+ * lane and zero otherwise. It is what comparing two real_lanes yields.
+ */
+typedef typeof((real_lanes){ 0 } < (real_lanes){ 0 }) lane_mask;
+
+/**
+ * tuple_packet - PACKET_WIDTH tuples in structure-of-arrays form:
+ * lane `i` of every component is the tuple <x[i], y[i], z[i], w[i]>.
+ */
+typedef struct tuple_packet tuple_packet;
+struct tuple_packet {
+	alignas(PACKET_WIDTH * sizeof(real)) real_lanes x;
+	real_lanes y;
+	real_lanes z;
+	real_lanes w;
+};
+
+/**
+ * ray_packet - PACKET_WIDTH rays with a mask of the lanes still in flight.
+ * Lanes outside `active` hold unspecified values and must not be used.
+ */
+typedef struct ray_packet ray_packet;
+struct ray_packet {
+	tuple_packet orig;
+	tuple_packet dir;
+	lane_mask active;
+};
+
+#define PACKET_INLINE [[__gnu__::__always_inline__]] static inline
+
+PACKET_INLINE
+real_lanes lanes_splat(real t) {
+	return (real_lanes){ } + t;
+}
+
+/**
+ * lanes_select - blends two lane vectors.
+ * @m: lane mask (input).
+ * @a: value for the lanes set in `m` (input).
+ * @b: value for the other lanes (input).
+ * @Returns: per lane, m ? a : b.
+ */
+PACKET_INLINE
+real_lanes lanes_select(lane_mask m, real_lanes a, real_lanes b) {
+	return (real_lanes)(((lane_mask)a & m) | ((lane_mask)b & ~m));
+}
+
+/**
+ * lanes_sqrt - square root of every lane. Written as a plain loop, which
+ * GCC turns into a single vector square root at -O3.
+ */
+PACKET_INLINE
+real_lanes lanes_sqrt(real_lanes l) {
+	real_lanes r;
+	for (unsigned i = 0; i < PACKET_WIDTH; i++)
+		r[i] = sqrt(l[i]);
+	return r;
+}
+
+/**
+ * mask_bits - packs a lane mask into an integer, one bit per lane.
+ * @m: lane mask (input).
+ * @Returns: bit `i` set when lane `i` is set.
+ */
+PACKET_INLINE
+uint32_t mask_bits(lane_mask m) {
+	uint32_t bits = 0;
+	for (unsigned i = 0; i < PACKET_WIDTH; i++)
+		bits |= (uint32_t)(m[i] & 1) << i;
+	return bits;
+}
+
+PACKET_INLINE
+bool mask_any(lane_mask m) {
+	return mask_bits(m) != 0;
+}
+
+/**
+ * mask_first - the mask with the first `n` lanes set.
+ * @n: number of lanes to set; values above PACKET_WIDTH set them all.
+ * @Returns: lane mask.
+ */
+PACKET_INLINE
+lane_mask mask_first(size_t n) {
+	lane_mask m;
+	for (unsigned i = 0; i < PACKET_WIDTH; i++)
+		m[i] = i < n ? -1 : 0;
+	return m;
+}
+
+/**
+ * packet_splat - a packet holding `t` in every lane.
+ */
+PACKET_INLINE
+tuple_packet packet_splat(tuple t) {
+	return (tuple_packet){
+		.x=lanes_splat(t.x), .y=lanes_splat(t.y),
+		.z=lanes_splat(t.z), .w=lanes_splat(t.w),
+	};
+}
+
+/**
+ * packet_get - extracts one lane of a packet.
+ * @p: pointer to the packet (input).
+ * @i: lane, below PACKET_WIDTH.
+ * @Returns: the tuple in lane `i`.
+ */
+PACKET_INLINE
+tuple packet_get(tuple_packet const* p, unsigned i) {
+	return (tuple){ .x=p->x[i], .y=p->y[i], .z=p->z[i], .w=p->w[i] };
+}
+
+/**
+ * packet_set - stores a tuple into one lane of a packet.
+ * @p: pointer to the packet (output).
+ * @i: lane, below PACKET_WIDTH.
+ * @t: tuple to store (input).
+ */
+PACKET_INLINE
+void packet_set(tuple_packet* p, unsigned i, tuple t) {
+	p->x[i] = t.x;
+	p->y[i] = t.y;
+	p->z[i] = t.z;
+	p->w[i] = t.w;
+}
+
+PACKET_INLINE
+tuple_packet packet_add(tuple_packet u, tuple_packet v) {
+	return (tuple_packet){ .x=u.x + v.x, .y=u.y + v.y, .z=u.z + v.z, .w=u.w + v.w };
+}
+
+PACKET_INLINE
+tuple_packet packet_sub(tuple_packet u, tuple_packet v) {
+	return (tuple_packet){ .x=u.x - v.x, .y=u.y - v.y, .z=u.z - v.z, .w=u.w - v.w };
+}
+
+/**
+ * packet_scale - multiplies every lane by its own scalar.
+ * @u: packet (input).
+ * @t: per-lane multipliers (input).
+ * @Returns: u[i] * t[i] for every lane.
+ */
+PACKET_INLINE
+tuple_packet packet_scale(tuple_packet u, real_lanes t) {
+	return (tuple_packet){ .x=u.x * t, .y=u.y * t, .z=u.z * t, .w=u.w * t };
+}
+
+PACKET_INLINE
+real_lanes packet_dot(tuple_packet u, tuple_packet v) {
+	return (u.x * v.x) + (u.y * v.y) + (u.z * v.z) + (u.w * v.w);
+}
+
+/**
+ * packet_cross - per-lane cross product. The results are vectors (w = 0).
+ */
+PACKET_INLINE
+tuple_packet packet_cross(tuple_packet u, tuple_packet v) {
+	return (tuple_packet){
+		.x=(u.y * v.z) - (u.z * v.y),
+		.y=(u.z * v.x) - (u.x * v.z),
+		.z=(u.x * v.y) - (u.y * v.x),
+	};
+}
+
+/**
+ * packet_unit - normalises every lane. Lanes of zero length become NaN,
+ * as with `unit_vec3`.
+ */
+PACKET_INLINE
+tuple_packet packet_unit(tuple_packet u) {
+	real_lanes inv = 1 / lanes_sqrt(packet_dot(u, u));
+	return packet_scale(u, inv);
+}
+
+/**
+ * ray_packet_at - the point at distance t[i] along ray `i`, for every lane.
+ * @r: pointer to the ray packet (input).
+ * @t: per-lane distances (input).
+ * @Returns: orig + dir * t, lane by lane.
+ */
+PACKET_INLINE
+tuple_packet ray_packet_at(ray_packet const* r, real_lanes t) {
+	return (tuple_packet){
+		.x=r->orig.x + r->dir.x * t,
+		.y=r->orig.y + r->dir.y * t,
+		.z=r->orig.z + r->dir.z * t,
+		.w=r->orig.w,
+	};
+}
+
+/**
+ * ray_packet_load - gathers up to PACKET_WIDTH rays into a packet. Lanes
+ * past `n` are zeroed and left out of the active mask.
+ * @rays: array of `n` rays (input).
+ * @n: number of rays to load.
+ * @out: pointer to the ray packet (output).
+ * @Returns: `out`, or null when `rays` or `out` is null.
+ */
+static
+inline
+ray_packet* ray_packet_load(ray const* rays, size_t n, ray_packet* out) {
+	if (rays && out) {
+		*out = (ray_packet){ .active=mask_first(n) };
+		for (unsigned i = 0; i < PACKET_WIDTH && i < n; i++) {
+			packet_set(&out->orig, i, rays[i].orig);
+			packet_set(&out->dir, i, rays[i].dir);
+		}
+		return out;
+	}
+	return nullptr;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef MY_QOI_H
+#define MY_QOI_H 1
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define QOI_HEADER_SIZE 14
+#define QOI_END_SIZE 8
+#define QOI_PIXEL_MAX 4 // Worst-case bytes per pixel (a full RGB chunk).
+
+/**
+ * qoi_enc - state of a QOI ("Quite OK Image") encoder over a stream of
+ * 8-bit RGB pixels. The stream may be fed in pieces, and independent
+ * encoders may produce consecutive pieces of the same image: an encoder
+ * seeded with the pixel preceding its piece only ever refers to colours it
+ * has seen itself, which a sequential decoder is guaranteed to agree with.
+ */
+typedef struct qoi_enc qoi_enc;
+struct qoi_enc {
+	uint8_t index[64][3]; // Recently seen colours, by hash.
+	uint64_t valid; // Bit i is set once index[i] is known to the decoder.
+	uint8_t prev[3];
+	unsigned run;
+};
+
+/**
+ * qoi_header - writes the header of a `w` by `h` RGB image to `out`.
+ */
+void qoi_header(uint32_t w, uint32_t h, uint8_t out[static QOI_HEADER_SIZE]);
+
+/**
+ * qoi_enc_init - prepares an encoder.
+ * @e: pointer to the encoder.
+ * @prev: pointer to the RGB pixel that precedes the encoder's first pixel in
+ * the image. Null if the encoder starts the image.
+ */
+void qoi_enc_init(qoi_enc* e, uint8_t const* prev);
+
+/**
+ * qoi_encode - encodes `n` pixels. A run still open after the last pixel is
+ * carried over to the next call.
+ * @e: pointer to the encoder.
+ * @rgb: pointer to 3 * `n` bytes of packed RGB (input).
+ * @n: number of pixels.
+ * @out: pointer to at least QOI_PIXEL_MAX * `n` bytes, or QOI_PIXEL_MAX *
+ * `n` + 1 bytes when a run may be pending from the previous call (output).
+ * @Returns: number of bytes written.
+ */
+size_t qoi_encode(qoi_enc* e, uint8_t const* restrict rgb, size_t n, uint8_t* restrict out);
+
+/**
+ * qoi_flush - closes the pending run, if any.
+ * @e: pointer to the encoder.
+ * @out: pointer to at least one byte (output).
+ * @Returns: number of bytes written.
+ */
+size_t qoi_flush(qoi_enc* e, uint8_t* out);
+
+/**
+ * qoi_end - writes the end-of-stream marker to `out`.
+ */
+void qoi_end(uint8_t out[static QOI_END_SIZE]);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef MY_QTRANSFORM_H
+#define MY_QTRANSFORM_H 1
+
+#include "mat.h"
+
+/**
+ * qtransform - compact similarity transform: a rotation by the unit
+ * quaternion `rotation`, then a uniform `scale`, then a `translation`.
+ * It covers rigid and uniformly scaled instances in half the space of a
+ * mat16 (32 bytes with float reals, 64 with double), and composes with a
+ * quaternion product instead of a 4x4 matrix product.
+ * @rotation: unit quaternion.
+ * @translation: x, y and z of the translation.
+ * @scale: uniform scale factor, non-zero.
+ */
+typedef struct qtransform qtransform;
+struct qtransform {
+	quat rotation;
+	real translation[3];
+	real scale;
+};
+
+#define QTRANSFORM_IDENTITY ((qtransform){ .rotation=QUAT(0, 0, 0, 1), .scale=1 })
+
+#define QTRANSFORM_FROM_MAT16(a) (qtransform_from_mat16((a), (&(qtransform){ })))
+/**
+ * qtransform_from_mat16 - decomposes the 4x4 matrix `a` into a rotation,
+ * uniform scale and translation. Fails unless `a` is affine and its 3x3
+ * part is a rotation times a positive uniform scale (within 1e-5).
+ * @a: pointer to a 4x4 matrix (input).
+ * @out: pointer to a compact transform (output).
+ * @Returns: `out`. Otherwise, null.
+ */
+qtransform* qtransform_from_mat16(mat16 const* a, qtransform* out);
+
+#define MAT16_FROM_QTRANSFORM(a) (mat16_from_qtransform((a), (&(mat16){ })))
+/**
+ * mat16_from_qtransform - expands the compact transform `a` to a 4x4 matrix.
+ * @a: pointer to a compact transform (input).
+ * @out: pointer to a 4x4 matrix (output).
+ * @Returns: `out`. Otherwise, null.
+ */
+mat16* mat16_from_qtransform(qtransform const* a, mat16* out);
+
+#define QTRANSFORM_COMPOSE(a, b) (qtransform_compose((a), (b), (&(qtransform){ })))
+/**
+ * qtransform_compose - the transform that applies `b` and then `a`, the
+ * counterpart of the matrix product a * b.
+ * @a: pointer to a compact transform (first input).
+ * @b: pointer to a compact transform (second input).
+ * @out: pointer to a compact transform (output). May alias `a` or `b`.
+ * @Returns: `out`. Otherwise, null.
+ */
+qtransform* qtransform_compose(qtransform const* a, qtransform const* b, qtransform* out);
+
+#define QTRANSFORM_INVERSE(a) (qtransform_inverse((a), (&(qtransform){ })))
+/**
+ * qtransform_inverse - inverts `a`: conjugate rotation, reciprocal scale
+ * and the translation taken back through both.
+ * @a: pointer to a compact transform (input).
+ * @out: pointer to a compact transform (output). May be `a` itself.
+ * @Returns: `out`. Otherwise, null.
+ */
+qtransform* qtransform_inverse(qtransform const* a, qtransform* out);
+
+#define QTRANSFORM_TUPLE(a, b) (qtransform_tuple((a), (b), (&(tuple){ })))
+/**
+ * qtransform_tuple - applies `a` to the tuple `b`: points (w = 1) are
+ * rotated, scaled and translated, vectors (w = 0) only rotated and scaled.
+ * @a: pointer to a compact transform (input).
+ * @b: pointer to a tuple (input).
+ * @out: pointer to a tuple (output). May alias `b`.
+ * @Returns: `out`. Otherwise, null.
+ */
+tuple* qtransform_tuple(qtransform const* a, tuple const* b, tuple* out);
+
+#endif
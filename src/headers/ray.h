@@ -10,14 +10,15 @@ struct ray {
 };
 
 static
-point3* at(ray const* r, double t, point3* out) {
+inline
+point3* at(ray const* r, real t, point3* out) {
 	if (r && out) {
 		vec3 tmp = {
 			.x = r->dir.x,
 			.y = r->dir.y,
 			.z = r->dir.z
 		};
-		add(&r->orig, scalar_mul(&tmp, t), out);
+		add(&r->orig, VEC3_MUL(&tmp, t), out);
 		return out;
 	}
 	return nullptr;
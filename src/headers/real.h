@@ -0,0 +1,41 @@
+#ifndef MY_REAL_H
+#define MY_REAL_H 1
+
+/*
+ * real - the scalar type of the whole math layer: tuples, matrices and the
+ * rays built from them. It is chosen at build time with `make RT_REAL=float`
+ * (twice the SIMD width) or `make RT_REAL=double` (the default), so no
+ * float/double conversions happen between vectors and matrices.
+ *
+ * Colours are not affected: col3 is the framebuffer and PFM storage format
+ * and is always float.
+ *
+ * <tgmath.h> makes sqrt, fabs, sin, cos and friends follow the argument
+ * type, so the same source computes in float or double.
+ */
+#include <assert.h>
+#include <stdbool.h>
+#include <tgmath.h>
+
+#ifndef RT_REAL
+# define RT_REAL double
+#endif
+
+typedef RT_REAL real;
+
+static_assert(sizeof(real) == sizeof(float) || sizeof(real) == sizeof(double),
+		"RT_REAL must be float or double");
+
+/*
+ * REAL_EPSILON - the tolerance under which two reals compare equal, as used
+ * by the matrix and transform code to spot singular or non-affine inputs.
+ */
+#define REAL_EPSILON 1E-5
+
+static
+inline
+bool real_equal(real a, real b) {
+	return fabs(a - b) < REAL_EPSILON;
+}
+
+#endif
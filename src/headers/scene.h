@@ -0,0 +1,87 @@
+#ifndef MY_SCENE_H
+#define MY_SCENE_H 1
+
+#include <stdbool.h>
+
+#include "transform.h"
+
+/**
+ * scene_node - a node of a transform hierarchy. Its world transform is its
+ * parent's world transform times its own local one, and is cached along
+ * with its inverse and inverse transpose. Changing a node's local transform
+ * or its parent only marks that node's subtree dirty; world transforms are
+ * recomputed on demand, and only for dirty nodes.
+ *
+ * Nodes are owned by the caller and linked intrusively: the graph never
+ * allocates. Use the functions below rather than touching the fields.
+ * @local: transform relative to the parent, with its cached inverse.
+ * @world: cached transform relative to the scene root. Valid when !dirty.
+ * @parent: parent node, or null for a root.
+ * @first_child: first child, or null.
+ * @next_sibling: next child of the same parent, or null.
+ * @dirty: `world` is stale. If a node is dirty, so is its whole subtree.
+ */
+typedef struct scene_node scene_node;
+struct scene_node {
+	transform local;
+	transform world;
+	scene_node* parent;
+	scene_node* first_child;
+	scene_node* next_sibling;
+	bool dirty;
+};
+
+/**
+ * scene_node_init - initialises a detached node with the local transform `m`.
+ * @node: pointer to the node (output).
+ * @m: pointer to a 4x4 matrix (input).
+ * @Returns: `node`. Otherwise, null (also when `m` is not invertible).
+ */
+scene_node* scene_node_init(scene_node* node, mat16 const* m);
+
+/**
+ * scene_node_set_local - replaces the local transform of `node` with `m`
+ * and marks its subtree dirty.
+ * @node: pointer to the node.
+ * @m: pointer to a 4x4 matrix (input).
+ * @Returns: `node`. Otherwise, null, leaving `node` unchanged (also when `m`
+ * is not invertible).
+ */
+scene_node* scene_node_set_local(scene_node* node, mat16 const* m);
+
+/**
+ * scene_node_attach - makes `child` the last child of `parent`, detaching it
+ * from its previous parent first, and marks its subtree dirty.
+ * @parent: pointer to the new parent. Must not be in `child`'s subtree.
+ * @child: pointer to the node to attach.
+ * @Returns: `child`. Otherwise, null.
+ */
+scene_node* scene_node_attach(scene_node* parent, scene_node* child);
+
+/**
+ * scene_node_detach - unlinks `node` from its parent, making it a root, and
+ * marks its subtree dirty.
+ * @node: pointer to the node.
+ * @Returns: `node`. Otherwise, null.
+ */
+scene_node* scene_node_detach(scene_node* node);
+
+/**
+ * scene_node_world - the world transform of `node`, recomputing it (and
+ * any dirty ancestors) first if needed. Recomputing takes two matrix
+ * products, since the world inverse is the local inverse times the
+ * parent's world inverse.
+ * @node: pointer to the node.
+ * @Returns: the cached world transform. Otherwise, null.
+ */
+transform const* scene_node_world(scene_node* node);
+
+/**
+ * scene_update - brings every world transform in the subtree of `root` up
+ * to date, recomputing only the dirty ones.
+ * @root: pointer to the subtree root.
+ * @Returns: number of nodes in the subtree whose world transform was recomputed.
+ */
+size_t scene_update(scene_node* root);
+
+#endif
@@ -0,0 +1,75 @@
+#ifndef MY_SPHERE_H
+#define MY_SPHERE_H 1
+
+#include <stddef.h>
+
+#include "mat.h"
+#include "packet.h"
+#include "ray.h"
+
+/**
+ * sphere_batch - PACKET_WIDTH spheres in structure-of-arrays form. Every
+ * sphere is the unit sphere at the origin of its own object space, and is
+ * stored as its world-to-object affine transform: inverse[k][i] is element
+ * k (mat12 order) of the inverse transform of sphere `i`. One ray is then
+ * tested against all of them at once, one lane per sphere. Heap arrays must
+ * be aligned like the type: aligned_alloc(alignof(sphere_batch), ...).
+ * @inverse: world-to-object transforms, one lane per sphere.
+ * @active: lanes that hold a sphere.
+ */
+typedef struct sphere_batch sphere_batch;
+struct sphere_batch {
+	real_lanes inverse[12];
+	lane_mask active;
+};
+
+#define SPHERE_BATCH_EMPTY ((sphere_batch){ })
+
+/**
+ * sphere_batch_set - stores the sphere with centre `center` and radius
+ * `radius` in lane `i` and marks the lane active.
+ * @b: pointer to the batch (output).
+ * @i: lane, below PACKET_WIDTH.
+ * @center: pointer to the centre (input).
+ * @radius: radius, non-zero.
+ * @Returns: `b`. Otherwise, null.
+ */
+sphere_batch* sphere_batch_set(sphere_batch* b, unsigned i, point3 const* center, real radius);
+
+/**
+ * sphere_batch_set_transform - stores the unit sphere transformed by
+ * `forward` (object to world) in lane `i` and marks the lane active.
+ * @b: pointer to the batch (output).
+ * @i: lane, below PACKET_WIDTH.
+ * @forward: pointer to an affine transform (input).
+ * @Returns: `b`. Otherwise, null (also when `forward` is singular).
+ */
+sphere_batch* sphere_batch_set_transform(sphere_batch* b, unsigned i, mat12 const* forward);
+
+/**
+ * sphere_batch_intersect - intersects the ray `r` with every sphere of the
+ * batch. The ray is taken to each sphere's object space, where the
+ * quadratic |o + t d|^2 = 1 is solved lane-wise. The direction is not
+ * normalised, so `t` is measured along `r` as given.
+ * @b: pointer to the batch (input).
+ * @r: pointer to a ray (input).
+ * @t0: nearer intersection distance per lane (output); INFINITY on a miss.
+ * @t1: farther intersection distance per lane (output); INFINITY on a miss.
+ * @Returns: mask of the active lanes that the ray's line hits. Otherwise,
+ * an empty mask (also when a pointer is null).
+ */
+lane_mask sphere_batch_intersect(sphere_batch const* b, ray const* r, real_lanes* t0, real_lanes* t1);
+
+/**
+ * spheres_closest_hit - the nearest intersection in front of the ray's
+ * origin (t > 0) over `n` batches.
+ * @b: array of `n` batches (input).
+ * @n: number of batches.
+ * @r: pointer to a ray (input).
+ * @index: sphere hit, as batch * PACKET_WIDTH + lane (output). Untouched on
+ * a miss. May be null.
+ * @Returns: distance to the hit, or INFINITY on a miss.
+ */
+real spheres_closest_hit(sphere_batch const* b, size_t n, ray const* r, size_t* index);
+
+#endif
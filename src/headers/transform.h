@@ -0,0 +1,83 @@
+#ifndef MY_TRANSFORM_H
+#define MY_TRANSFORM_H 1
+
+#include "mat.h"
+#include "ray.h"
+
+/**
+ * transform - a 4x4 transform together with its inverse and the transpose
+ * of its inverse. All three are computed when the transform is set or
+ * changed, so intersecting a ray in object space and bringing normals back
+ * to world space cost a matrix-tuple product each, never an inversion.
+ * Change it only through `transform_set` and `transform_compose`, which
+ * keep the cached matrices consistent.
+ * @forward: object to world space.
+ * @inverse: world to object space.
+ * @inverse_transpose: transpose of `inverse`; maps object-space normals to
+ * world space.
+ */
+typedef struct transform transform;
+struct transform {
+	mat16 forward;
+	mat16 inverse;
+	mat16 inverse_transpose;
+};
+
+#define TRANSFORM_IDENTITY ((transform){ \
+	.forward=MAT16_IDENTITY, .inverse=MAT16_IDENTITY, .inverse_transpose=MAT16_IDENTITY })
+
+/**
+ * transform_set - sets `t` to the matrix `m` and caches its inverse and
+ * inverse transpose.
+ * @t: pointer to the transform (output).
+ * @m: pointer to a 4x4 matrix (input).
+ * @Returns: `t`. Otherwise, null, leaving `t` unchanged (also when `m` is
+ * not invertible).
+ */
+transform* transform_set(transform* t, mat16 const* m);
+
+/**
+ * transform_compose - applies `m` after the transform already in `t`:
+ * forward becomes m * forward, and the cached matrices are updated to match.
+ * @t: pointer to the transform (input and output).
+ * @m: pointer to a 4x4 matrix (input).
+ * @Returns: `t`. Otherwise, null, leaving `t` unchanged (also when `m` is
+ * not invertible).
+ */
+transform* transform_compose(transform* t, mat16 const* m);
+
+#define TRANSFORM_TUPLE(t, a) (transform_tuple((t), (a), (&(tuple){ })))
+/**
+ * transform_tuple - maps the point or vector `a` from object to world space.
+ * @t: pointer to the transform (input).
+ * @a: pointer to a tuple (input).
+ * @out: pointer to a tuple (output).
+ * @Returns: `out`. Otherwise, null.
+ */
+tuple* transform_tuple(transform const* t, tuple const* a, tuple* out);
+
+#define TRANSFORM_NORMAL(t, n) (transform_normal((t), (n), (&(vec3){ })))
+/**
+ * transform_normal - maps the object-space surface normal `n` to world
+ * space through the cached inverse transpose, and normalises it. The w
+ * component that translations leave behind is cleared first.
+ * @t: pointer to the transform (input).
+ * @n: pointer to a normal vector (input).
+ * @out: pointer to a vector (output).
+ * @Returns: `out`. Otherwise, null.
+ */
+vec3* transform_normal(transform const* t, vec3 const* n, vec3* out);
+
+#define TRANSFORM_RAY_TO_OBJECT(t, r) (transform_ray_to_object((t), (r), (&(ray){ })))
+/**
+ * transform_ray_to_object - maps the world-space ray `r` into object space
+ * through the cached inverse. The direction is not normalised, so ray
+ * distances stay the same in both spaces.
+ * @t: pointer to the transform (input).
+ * @r: pointer to a ray (input).
+ * @out: pointer to a ray (output).
+ * @Returns: `out`. Otherwise, null.
+ */
+ray* transform_ray_to_object(transform const* t, ray const* r, ray* out);
+
+#endif
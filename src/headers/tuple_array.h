@@ -0,0 +1,113 @@
+#ifndef MY_TUPLE_ARRAY_H
+#define MY_TUPLE_ARRAY_H 1
+
+#include <stddef.h>
+
+#include "vec3.h"
+
+/*
+ * Kernels over contiguous arrays of `n` tuples (mesh vertices, particle
+ * positions, ...). Each element is handled as one 4-lane vector, with no
+ * per-element calls or null checks, and the restrict-qualified buffers let
+ * the compiler keep the loops vectorized. Outputs must not overlap inputs;
+ * use the `_inplace` forms to update an array in place. Heap arrays must
+ * be aligned like tuple, e.g. `aligned_alloc(alignof(tuple), n * sizeof(tuple))`.
+ *
+ * All of them return `out` (or the updated array), or null when a pointer
+ * argument is null.
+ */
+
+/**
+ * tuple_array_add - out[i] = a[i] + b[i].
+ * @a: first array of `n` tuples (input).
+ * @b: second array of `n` tuples (input).
+ * @n: number of tuples.
+ * @out: array of `n` tuples (output).
+ */
+tuple* tuple_array_add(tuple const* restrict a, tuple const* restrict b, size_t n,
+		tuple* restrict out);
+
+/**
+ * tuple_array_add_inplace - a[i] += b[i].
+ */
+tuple* tuple_array_add_inplace(tuple* restrict a, tuple const* restrict b, size_t n);
+
+/**
+ * tuple_array_offset - out[i] = a[i] + t, e.g. translating a point cloud.
+ * @a: array of `n` tuples (input).
+ * @t: offset added to every tuple.
+ * @n: number of tuples.
+ * @out: array of `n` tuples (output).
+ */
+tuple* tuple_array_offset(tuple const* restrict a, tuple t, size_t n, tuple* restrict out);
+
+/**
+ * tuple_array_offset_inplace - a[i] += t.
+ */
+tuple* tuple_array_offset_inplace(tuple* a, tuple t, size_t n);
+
+/**
+ * tuple_array_scale - out[i] = a[i] * t.
+ * @a: array of `n` tuples (input).
+ * @t: scalar multiplier.
+ * @n: number of tuples.
+ * @out: array of `n` tuples (output).
+ */
+tuple* tuple_array_scale(tuple const* restrict a, real t, size_t n, tuple* restrict out);
+
+/**
+ * tuple_array_scale_inplace - a[i] *= t.
+ */
+tuple* tuple_array_scale_inplace(tuple* a, real t, size_t n);
+
+/**
+ * tuple_array_normalize - out[i] = a[i] / |a[i]|. Vectors of zero length
+ * become NaN, as with `unit_vec3`.
+ * @a: array of `n` vectors (input).
+ * @n: number of vectors.
+ * @out: array of `n` vectors (output).
+ */
+vec3* tuple_array_normalize(vec3 const* restrict a, size_t n, vec3* restrict out);
+
+/**
+ * tuple_array_normalize_inplace - a[i] /= |a[i]|.
+ */
+vec3* tuple_array_normalize_inplace(vec3* a, size_t n);
+
+/**
+ * tuple_array_normalize_fast - out[i] = tuple_unit_fast(a[i]): normalises
+ * with a reciprocal square root, within the error bound of `real_rsqrt`.
+ */
+vec3* tuple_array_normalize_fast(vec3 const* restrict a, size_t n, vec3* restrict out);
+
+/**
+ * tuple_array_normalize_fast_inplace - a[i] = tuple_unit_fast(a[i]).
+ */
+vec3* tuple_array_normalize_fast_inplace(vec3* a, size_t n);
+
+/**
+ * tuple_array_dot - out[i] = a[i] . b[i].
+ * @a: first array of `n` tuples (input).
+ * @b: second array of `n` tuples (input).
+ * @n: number of tuples.
+ * @out: array of `n` scalars (output).
+ */
+real* tuple_array_dot(tuple const* restrict a, tuple const* restrict b, size_t n,
+		real* restrict out);
+
+/**
+ * tuple_array_cross - out[i] = a[i] x b[i]. The results are vectors (w = 0).
+ * @a: first array of `n` vectors (input).
+ * @b: second array of `n` vectors (input).
+ * @n: number of vectors.
+ * @out: array of `n` vectors (output).
+ */
+vec3* tuple_array_cross(vec3 const* restrict a, vec3 const* restrict b, size_t n,
+		vec3* restrict out);
+
+/**
+ * tuple_array_cross_inplace - a[i] = a[i] x b[i].
+ */
+vec3* tuple_array_cross_inplace(vec3* restrict a, vec3 const* restrict b, size_t n);
+
+#endif
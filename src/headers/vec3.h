@@ -4,16 +4,30 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+#if defined(__SSE__)
+# include <xmmintrin.h>
+#endif
+
+#include "real.h"
+
+/*
+ * Four reals as one GCC vector. For float that is one SSE register. For
+ * double it is a single AVX instruction when built with -mavx, and a pair
+ * of SSE2 instructions otherwise. tuple is aligned to the vector size.
+ */
+typedef real real4 __attribute__((vector_size(4 * sizeof(real))));
+
 typedef struct tuple tuple;
 struct tuple {
 	union {
 		struct {
-			double x;
-			double y;
-			double z;
-			double w;
+			real x;
+			real y;
+			real z;
+			real w;
 		};
-		double data[4];
+		real data[4];
+		alignas(4 * sizeof(real)) real4 v;
 	};
 };
 
@@ -31,10 +45,7 @@ static
 inline
 tuple* negate(tuple const* t, tuple* out) {
 	if (t && out) {
-		out->x = -t->x;
-		out->y = -t->y;
-		out->z = -t->z;
-		out->w = -t->w;
+		out->v = -t->v;
 		return out;
 	}
 	return nullptr;
@@ -51,7 +62,7 @@ tuple* negate(tuple const* t, tuple* out) {
  */
 static
 inline
-double dot(vec3 const* u, vec3 const* v){
+real dot(vec3 const* u, vec3 const* v){
 	return (u && v) ? (u->x * v->x) + (u->y * v->y) + (u->z * v->z) + (u->w * v->w): NAN;
 }
 
@@ -66,12 +77,9 @@ double dot(vec3 const* u, vec3 const* v){
  */
 static
 inline
-tuple* scalar_mul(tuple const* u, double t, tuple* out) {
+tuple* scalar_mul(tuple const* u, real t, tuple* out) {
 	if (u && out) {
-		out->x = u->x * t;
-		out->y = u->y * t;
-		out->z = u->z * t;
-		out->w = u->w * t;
+		out->v = u->v * t;
 		return out;
 	}
 	return nullptr;
@@ -88,12 +96,9 @@ tuple* scalar_mul(tuple const* u, double t, tuple* out) {
  */
 static
 inline
-tuple* scalar_div(tuple const* u, double t, tuple* out) {
+tuple* scalar_div(tuple const* u, real t, tuple* out) {
 	if (u && out) {
-		out->x = u->x / t;
-		out->y = u->y / t;
-		out->z = u->z / t;
-		out->w = u->w / t;
+		out->v = u->v / t;
 		return out;
 	}
 	return nullptr;
@@ -107,7 +112,7 @@ tuple* scalar_div(tuple const* u, double t, tuple* out) {
  * */
 static
 inline
-double len_squared(vec3 const* u) {
+real len_squared(vec3 const* u) {
 	return u ? (u->x * u->x) + (u->y * u->y) + (u->z * u->z) + (u->w * u->w) : NAN;
 }
 
@@ -119,7 +124,7 @@ double len_squared(vec3 const* u) {
  */
 static
 inline
-double len(vec3 const* u) {
+real len(vec3 const* u) {
 	return u ? sqrt(len_squared(u)): NAN;
 }
 
@@ -169,4 +174,106 @@ tuple* add(tuple const* u, tuple const* v, tuple* out);
  */
 vec3* cross(vec3 const* u, vec3 const* v, vec3* out);
 
+/*
+ * Value API: the tuple operations above, taking and returning tuples by
+ * value. They never branch on null, never go through memory for their
+ * result and are always inlined, so chains such as
+ * `tuple_add(tuple_add(v, g), w)` compile down to straight-line arithmetic
+ * in registers. Prefer them on hot paths.
+ */
+#define TUPLE_INLINE [[__gnu__::__always_inline__]] static inline
+
+TUPLE_INLINE
+tuple tuple_add(tuple u, tuple v) {
+	return (tuple){ .v=u.v + v.v };
+}
+
+TUPLE_INLINE
+tuple tuple_sub(tuple u, tuple v) {
+	return (tuple){ .v=u.v - v.v };
+}
+
+TUPLE_INLINE
+tuple tuple_negate(tuple u) {
+	return (tuple){ .v=-u.v };
+}
+
+TUPLE_INLINE
+tuple tuple_scale(tuple u, real t) {
+	return (tuple){ .v=u.v * t };
+}
+
+TUPLE_INLINE
+tuple tuple_div(tuple u, real t) {
+	return (tuple){ .v=u.v / t };
+}
+
+TUPLE_INLINE
+real tuple_dot(tuple u, tuple v) {
+	real4 p = u.v * v.v;
+	return (p[0] + p[1]) + (p[2] + p[3]);
+}
+
+TUPLE_INLINE
+real tuple_len_squared(tuple u) {
+	return tuple_dot(u, u);
+}
+
+TUPLE_INLINE
+real tuple_len(tuple u) {
+	return sqrt(tuple_len_squared(u));
+}
+
+TUPLE_INLINE
+tuple tuple_unit(tuple u) {
+	return tuple_div(u, tuple_len(u));
+}
+
+/**
+ * real_rsqrt - reciprocal square root, 1 / sqrt(x).
+ * In float builds on SSE it is the hardware estimate (relative error below
+ * 1.5 * 2^-12) refined by one Newton-Raphson step, which leaves a relative
+ * error below 2^-21 for normal, positive `x`. In double builds it is
+ * computed exactly, as 1 / sqrt(x), with at most one ulp of error.
+ * As with 1 / sqrt(x), zero gives infinity.
+ * @x: non-negative input.
+ * @Returns: 1 / sqrt(x).
+ */
+TUPLE_INLINE
+real real_rsqrt(real x) {
+#if defined(__SSE__)
+	if (sizeof(real) == sizeof(float)) {
+		float y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss((float)x)));
+		return y * (1.5f - 0.5f * (float)x * y * y);
+	}
+#endif
+	return 1 / sqrt(x);
+}
+
+/**
+ * tuple_unit_fast - normalises `u` with one reciprocal square root and a
+ * multiplication instead of a square root and four divisions. Each
+ * component of the result is within the error of `real_rsqrt` (relative,
+ * plus one rounding) of `tuple_unit(u)`: about 2^-21 for float and a few
+ * ulps for double. A zero vector gives NaN, as with `tuple_unit`.
+ */
+TUPLE_INLINE
+tuple tuple_unit_fast(tuple u) {
+	return tuple_scale(u, real_rsqrt(tuple_len_squared(u)));
+}
+
+/**
+ * tuple_cross - value form of `cross`, as two lane rotations:
+ * u.yzx * v.zxy - u.zxy * v.yzx. The w lanes cancel, so for finite inputs
+ * the result is a vector (w = 0).
+ */
+TUPLE_INLINE
+tuple tuple_cross(tuple u, tuple v) {
+	real4 a = __builtin_shufflevector(u.v, u.v, 1, 2, 0, 3);
+	real4 b = __builtin_shufflevector(v.v, v.v, 2, 0, 1, 3);
+	real4 c = __builtin_shufflevector(u.v, u.v, 2, 0, 1, 3);
+	real4 d = __builtin_shufflevector(v.v, v.v, 1, 2, 0, 3);
+	return (tuple){ .v=a * b - c * d };
+}
+
 #endif
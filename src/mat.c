@@ -1,16 +1,10 @@
 #include "headers/mat.h"
 #include <stdio.h>
-
-#define EPSILON 1E-5
-
-static
-bool float_equal(float a, float b) {
-	return fabsf(a - b) < EPSILON;
-}
+#include <string.h>
 
 static
-void swap(float* restrict a, float* restrict b) {
-	float tmp = *a;
+void swap(real* restrict a, real* restrict b) {
+	real tmp = *a;
 	*a = *b;
 	*b = tmp;
 }
@@ -19,24 +13,56 @@ bool mat16_is_equal(mat16 const* a, mat16 const* b) {
 	bool flag = false;
 	if (a && b) {
 		for (unsigned i = 0; i < 16; i++)
-			if (!float_equal(a->data[i], b->data[i]))
+			if (!real_equal(a->data[i], b->data[i]))
 				return flag;
 		flag = true;
 	}
 	return flag;
 }
 
+/*
+ * mat16 rows are four consecutive reals but only real-aligned, so they are
+ * moved in and out of real4 registers with memcpy, which compiles to
+ * unaligned vector loads and stores.
+ */
+static
+inline
+real4 mat16_row(mat16 const* a, unsigned i) {
+	real4 r;
+	memcpy(&r, a->data + i * 4, sizeof r);
+	return r;
+}
+
+/*
+ * Columns of `a`: the rows transposed with two rounds of shuffles.
+ */
+static
+inline
+void mat16_columns(mat16 const* a, real4 col[static 4]) {
+	real4 r0 = mat16_row(a, 0), r1 = mat16_row(a, 1);
+	real4 r2 = mat16_row(a, 2), r3 = mat16_row(a, 3);
+	real4 t0 = __builtin_shufflevector(r0, r1, 0, 4, 1, 5);
+	real4 t1 = __builtin_shufflevector(r2, r3, 0, 4, 1, 5);
+	real4 t2 = __builtin_shufflevector(r0, r1, 2, 6, 3, 7);
+	real4 t3 = __builtin_shufflevector(r2, r3, 2, 6, 3, 7);
+	col[0] = __builtin_shufflevector(t0, t1, 0, 1, 4, 5);
+	col[1] = __builtin_shufflevector(t0, t1, 2, 3, 6, 7);
+	col[2] = __builtin_shufflevector(t2, t3, 0, 1, 4, 5);
+	col[3] = __builtin_shufflevector(t2, t3, 2, 3, 6, 7);
+}
+
 mat16* mat16_mul(mat16 const* a, mat16 const* b, mat16* c) {
 	if (a && b && c) {
-		for (unsigned i = 0; i < 4; i++)
-			for (unsigned j = 0; j < 4; j++) {
-				float _a = a->data[i*4+0] * b->data[0*4+j];
-				float _b = a->data[i*4+1] * b->data[1*4+j];
-				float _c = a->data[i*4+2] * b->data[2*4+j];
-				float _d = a->data[i*4+3] * b->data[3*4+j];
-
-				c->data[i*4+j] = _a + _b + _c + _d;
-			}
+		// Row i of the product is sum_k a[i][k] * (row k of b): broadcast and FMA.
+		real4 b0 = mat16_row(b, 0), b1 = mat16_row(b, 1);
+		real4 b2 = mat16_row(b, 2), b3 = mat16_row(b, 3);
+		mat16 r;
+		for (unsigned i = 0; i < 4; i++) {
+			real const* row = a->data + i * 4;
+			real4 p = row[0] * b0 + row[1] * b1 + row[2] * b2 + row[3] * b3;
+			memcpy(r.data + i * 4, &p, sizeof p);
+		}
+		*c = r;
 		return c;
 	}
 	return nullptr;
@@ -44,14 +70,21 @@ mat16* mat16_mul(mat16 const* a, mat16 const* b, mat16* c) {
 
 tuple* mat16_mul_by_tuple(mat16 const* a, tuple const* b, tuple* out) {
 	if (a && b && out) {
-		for (unsigned i = 0; i < 4; i++) {
-			float _a = a->data[i*4+0] * b->x;
-			float _b = a->data[i*4+1] * b->y;
-			float _c = a->data[i*4+2] * b->z;
-			float _d = a->data[i*4+3] * b->w;
+		real4 col[4];
+		mat16_columns(a, col);
+		out->v = b->x * col[0] + b->y * col[1] + b->z * col[2] + b->w * col[3];
+		return out;
+	}
+	return nullptr;
+}
 
-			out->data[i] = _a + _b + _c + _d;
-		}
+tuple* mat16_mul_tuple_array(mat16 const* restrict a, tuple const* restrict in, size_t n,
+		tuple* restrict out) {
+	if (a && in && out) {
+		real4 col[4];
+		mat16_columns(a, col);
+		for (size_t i = 0; i < n; i++)
+			out[i].v = in[i].x * col[0] + in[i].y * col[1] + in[i].z * col[2] + in[i].w * col[3];
 		return out;
 	}
 	return nullptr;
@@ -69,57 +102,90 @@ mat16* mat16_transpose(mat16 *a) {
 	return a;
 }
 
-float mat4_determinant(mat4 const* a) {
+real mat4_determinant(mat4 const* a) {
 	if (a) {
-		float first_diagonal = a->data[0] * a->data[3];
-		float sec_diagonal = a->data[1] * a->data[2];
+		real first_diagonal = a->data[0] * a->data[3];
+		real sec_diagonal = a->data[1] * a->data[2];
 		return first_diagonal - sec_diagonal;
 	}
 	return NAN;
 }
 
 
-float mat9_minor(mat9 const* a, unsigned r, unsigned c) {
+real mat9_minor(mat9 const* a, unsigned r, unsigned c) {
 	return a ? mat4_determinant(MAT9_SUBMATRIX(a, r, c)): NAN;
 }
 
-float mat9_cofactor(mat9 const* a, unsigned r, unsigned c) {
+real mat9_cofactor(mat9 const* a, unsigned r, unsigned c) {
 	if (a) {
-		float res = mat9_minor(a, r, c);
+		real res = mat9_minor(a, r, c);
 		return (r + c) & 1 ? -res: res; 
 	}
 	return NAN;
 }
 
-float mat9_determinant(const mat9 *a) {
+real mat9_determinant(const mat9 *a) {
 	if (a) {
-		float col0 = a->m00 * mat9_cofactor(a, 0, 0);
-		float col1 = a->m01 * mat9_cofactor(a, 0, 1);
-		float col2 = a->m02 * mat9_cofactor(a, 0, 2);
+		real col0 = a->m00 * mat9_cofactor(a, 0, 0);
+		real col1 = a->m01 * mat9_cofactor(a, 0, 1);
+		real col2 = a->m02 * mat9_cofactor(a, 0, 2);
 		return col0 + col1 + col2;
 	}
 	return NAN;
 }
 
-float mat16_minor(mat16 const* a, unsigned r, unsigned c) {
+/*
+ * The twelve 2x2 sub-determinants that a 4x4 determinant and adjugate are
+ * built from: `s` from the top two rows, `c` from the bottom two. Computing
+ * them once replaces the 16 cofactor expansions (each through a mat9 and
+ * three mat4) of the textbook inverse.
+ */
+typedef struct mat16_minors mat16_minors;
+struct mat16_minors {
+	real s0, s1, s2, s3, s4, s5;
+	real c0, c1, c2, c3, c4, c5;
+};
+
+static
+mat16_minors mat16_minors_of(mat16 const* a) {
+	return (mat16_minors){
+		.s0 = a->m00 * a->m11 - a->m10 * a->m01,
+		.s1 = a->m00 * a->m12 - a->m10 * a->m02,
+		.s2 = a->m00 * a->m13 - a->m10 * a->m03,
+		.s3 = a->m01 * a->m12 - a->m11 * a->m02,
+		.s4 = a->m01 * a->m13 - a->m11 * a->m03,
+		.s5 = a->m02 * a->m13 - a->m12 * a->m03,
+		.c0 = a->m20 * a->m31 - a->m30 * a->m21,
+		.c1 = a->m20 * a->m32 - a->m30 * a->m22,
+		.c2 = a->m20 * a->m33 - a->m30 * a->m23,
+		.c3 = a->m21 * a->m32 - a->m31 * a->m22,
+		.c4 = a->m21 * a->m33 - a->m31 * a->m23,
+		.c5 = a->m22 * a->m33 - a->m32 * a->m23,
+	};
+}
+
+static
+real mat16_minors_determinant(mat16_minors const* m) {
+	return m->s0 * m->c5 - m->s1 * m->c4 + m->s2 * m->c3
+		+ m->s3 * m->c2 - m->s4 * m->c1 + m->s5 * m->c0;
+}
+
+real mat16_minor(mat16 const* a, unsigned r, unsigned c) {
 	return a ? mat9_determinant(MAT16_SUBMATRIX(a, r, c)) : NAN;
 }
 
-float mat16_cofactor(mat16 const* a, unsigned r, unsigned c) {
+real mat16_cofactor(mat16 const* a, unsigned r, unsigned c) {
 	if (a) {
-		float res = mat16_minor(a, r, c);
+		real res = mat16_minor(a, r, c);
 		return (r + c) & 1 ? -res: res;
 	}
 	return NAN;
 }
 
-float mat16_determinant(const mat16 *a) {
+real mat16_determinant(const mat16 *a) {
 	if (a) {
-		float col0 = a->m00 * mat16_cofactor(a, 0, 0);
-		float col1 = a->m01 * mat16_cofactor(a, 0, 1);
-		float col2 = a->m02 * mat16_cofactor(a, 0, 2);
-		float col3 = a->m03 * mat16_cofactor(a, 0, 3);
-		return col0 + col1 + col2 + col3;
+		mat16_minors m = mat16_minors_of(a);
+		return mat16_minors_determinant(&m);
 	}
 	return NAN;
 }
@@ -182,17 +248,296 @@ mat4* mat9_submatrix(mat9 const* a, unsigned r, unsigned c, mat4* out) {
 
 mat16* mat16_inverse(mat16 const* a, mat16* out) {
 	if (a && out) {
-		float det_a = mat16_determinant(a);
-		if (float_equal(det_a, 0)) {
+		mat16_minors m = mat16_minors_of(a);
+		real det_a = mat16_minors_determinant(&m);
+		if (real_equal(det_a, 0)) {
 			fprintf(stderr, "Matrix is not invertible.\n");
 			return nullptr;
 		}
-		for (unsigned r = 0; r < 4; r++)
-			for (unsigned c = 0; c < 4; c++)
-				out->data[c * 4 + r] = mat16_cofactor(a, r, c) / det_a;
+		real k = 1 / det_a;
+		// Adjugate times 1/det; built in a temporary so `out` may alias `a`.
+		*out = (mat16){
+			.m00 = ( a->m11 * m.c5 - a->m12 * m.c4 + a->m13 * m.c3) * k,
+			.m01 = (-a->m01 * m.c5 + a->m02 * m.c4 - a->m03 * m.c3) * k,
+			.m02 = ( a->m31 * m.s5 - a->m32 * m.s4 + a->m33 * m.s3) * k,
+			.m03 = (-a->m21 * m.s5 + a->m22 * m.s4 - a->m23 * m.s3) * k,
+			.m10 = (-a->m10 * m.c5 + a->m12 * m.c2 - a->m13 * m.c1) * k,
+			.m11 = ( a->m00 * m.c5 - a->m02 * m.c2 + a->m03 * m.c1) * k,
+			.m12 = (-a->m30 * m.s5 + a->m32 * m.s2 - a->m33 * m.s1) * k,
+			.m13 = ( a->m20 * m.s5 - a->m22 * m.s2 + a->m23 * m.s1) * k,
+			.m20 = ( a->m10 * m.c4 - a->m11 * m.c2 + a->m13 * m.c0) * k,
+			.m21 = (-a->m00 * m.c4 + a->m01 * m.c2 - a->m03 * m.c0) * k,
+			.m22 = ( a->m30 * m.s4 - a->m31 * m.s2 + a->m33 * m.s0) * k,
+			.m23 = (-a->m20 * m.s4 + a->m21 * m.s2 - a->m23 * m.s0) * k,
+			.m30 = (-a->m10 * m.c3 + a->m11 * m.c1 - a->m12 * m.c0) * k,
+			.m31 = ( a->m00 * m.c3 - a->m01 * m.c1 + a->m02 * m.c0) * k,
+			.m32 = (-a->m30 * m.s3 + a->m31 * m.s1 - a->m32 * m.s0) * k,
+			.m33 = ( a->m20 * m.s3 - a->m21 * m.s1 + a->m22 * m.s0) * k,
+		};
+		return out;
+	}
+	return nullptr;
+}
+
+mat16_soa* mat16_soa_set(mat16_soa* a, unsigned i, mat16 const* m) {
+	if (a && m && i < PACKET_WIDTH) {
+		for (unsigned k = 0; k < 16; k++)
+			a->data[k][i] = m->data[k];
+		return a;
+	}
+	return nullptr;
+}
+
+mat16* mat16_soa_get(mat16_soa const* a, unsigned i, mat16* out) {
+	if (a && out && i < PACKET_WIDTH) {
+		for (unsigned k = 0; k < 16; k++)
+			out->data[k] = a->data[k][i];
+		return out;
+	}
+	return nullptr;
+}
+
+/*
+ * The lane-wise counterpart of mat16_minors; `d[k]` holds element k of
+ * every matrix in the batch.
+ */
+typedef struct mat16_soa_minors mat16_soa_minors;
+struct mat16_soa_minors {
+	real_lanes s0, s1, s2, s3, s4, s5;
+	real_lanes c0, c1, c2, c3, c4, c5;
+};
+
+static
+mat16_soa_minors mat16_soa_minors_of(mat16_soa const* a) {
+	real_lanes const* d = a->data;
+	return (mat16_soa_minors){
+		.s0 = d[0] * d[5] - d[4] * d[1],
+		.s1 = d[0] * d[6] - d[4] * d[2],
+		.s2 = d[0] * d[7] - d[4] * d[3],
+		.s3 = d[1] * d[6] - d[5] * d[2],
+		.s4 = d[1] * d[7] - d[5] * d[3],
+		.s5 = d[2] * d[7] - d[6] * d[3],
+		.c0 = d[8] * d[13] - d[12] * d[9],
+		.c1 = d[8] * d[14] - d[12] * d[10],
+		.c2 = d[8] * d[15] - d[12] * d[11],
+		.c3 = d[9] * d[14] - d[13] * d[10],
+		.c4 = d[9] * d[15] - d[13] * d[11],
+		.c5 = d[10] * d[15] - d[14] * d[11],
+	};
+}
+
+static
+real_lanes mat16_soa_minors_determinant(mat16_soa_minors const* m) {
+	return m->s0 * m->c5 - m->s1 * m->c4 + m->s2 * m->c3
+		+ m->s3 * m->c2 - m->s4 * m->c1 + m->s5 * m->c0;
+}
+
+real_lanes mat16_soa_determinant(mat16_soa const* a) {
+	mat16_soa_minors m = mat16_soa_minors_of(a);
+	return mat16_soa_minors_determinant(&m);
+}
+
+uint32_t mat16_soa_inverse(mat16_soa const* a, mat16_soa* out) {
+	real_lanes const* d = a->data;
+	mat16_soa_minors m = mat16_soa_minors_of(a);
+	real_lanes det = mat16_soa_minors_determinant(&m);
+	lane_mask ok = (det >= (real)REAL_EPSILON) | (det <= -(real)REAL_EPSILON);
+	// Singular lanes divide by one and are masked to zero below.
+	real_lanes k = lanes_select(ok, 1 / lanes_select(ok, det, lanes_splat(1)), lanes_splat(0));
+
+	mat16_soa r = { .data = {
+		( d[5] * m.c5 - d[6] * m.c4 + d[7] * m.c3) * k,
+		(-d[1] * m.c5 + d[2] * m.c4 - d[3] * m.c3) * k,
+		( d[13] * m.s5 - d[14] * m.s4 + d[15] * m.s3) * k,
+		(-d[9] * m.s5 + d[10] * m.s4 - d[11] * m.s3) * k,
+		(-d[4] * m.c5 + d[6] * m.c2 - d[7] * m.c1) * k,
+		( d[0] * m.c5 - d[2] * m.c2 + d[3] * m.c1) * k,
+		(-d[12] * m.s5 + d[14] * m.s2 - d[15] * m.s1) * k,
+		( d[8] * m.s5 - d[10] * m.s2 + d[11] * m.s1) * k,
+		( d[4] * m.c4 - d[5] * m.c2 + d[7] * m.c0) * k,
+		(-d[0] * m.c4 + d[1] * m.c2 - d[3] * m.c0) * k,
+		( d[12] * m.s4 - d[13] * m.s2 + d[15] * m.s0) * k,
+		(-d[8] * m.s4 + d[9] * m.s2 - d[11] * m.s0) * k,
+		(-d[4] * m.c3 + d[5] * m.c1 - d[6] * m.c0) * k,
+		( d[0] * m.c3 - d[1] * m.c1 + d[2] * m.c0) * k,
+		(-d[12] * m.s3 + d[13] * m.s1 - d[14] * m.s0) * k,
+		( d[8] * m.s3 - d[9] * m.s1 + d[10] * m.s0) * k,
+	} };
+	*out = r;
+	return mask_bits(ok);
+}
+
+size_t mat16_inverse_batch(mat16_soa const* a, size_t n, mat16_soa* out, uint32_t* status) {
+	size_t invertible = 0;
+	if (a && out && status)
+		for (size_t j = 0; j < n; j++) {
+			status[j] = mat16_soa_inverse(&a[j], &out[j]);
+			invertible += (size_t)__builtin_popcount(status[j]);
+		}
+	return invertible;
+}
+
+/*
+ * sin(d degrees) for d = 0..90, to double precision; cos(d) = sin(90 - d).
+ */
+static
+double const sin_degrees[91] = {
+	0.0, 0.01745240643728351, 0.03489949670250097, 0.052335956242943835,
+	0.0697564737441253, 0.08715574274765817, 0.10452846326765347, 0.12186934340514748,
+	0.13917310096006544, 0.15643446504023087, 0.17364817766693033, 0.1908089953765448,
+	0.20791169081775934, 0.224951054343865, 0.24192189559966773, 0.25881904510252074,
+	0.27563735581699916, 0.29237170472273677, 0.3090169943749474, 0.3255681544571567,
+	0.3420201433256687, 0.35836794954530027, 0.374606593415912, 0.39073112848927377,
+	0.4067366430758002, 0.42261826174069944, 0.4383711467890774, 0.45399049973954675,
+	0.4694715627858908, 0.48480962024633706, 0.5, 0.5150380749100542,
+	0.5299192642332049, 0.5446390350150271, 0.5591929034707469, 0.573576436351046,
+	0.5877852522924731, 0.6018150231520483, 0.6156614753256583, 0.6293203910498374,
+	0.6427876096865393, 0.6560590289905073, 0.6691306063588582, 0.6819983600624985,
+	0.6946583704589973, 0.7071067811865475, 0.7193398003386511, 0.7313537016191705,
+	0.7431448254773942, 0.754709580222772, 0.766044443118978, 0.7771459614569709,
+	0.788010753606722, 0.7986355100472928, 0.8090169943749475, 0.8191520442889918,
+	0.8290375725550417, 0.838670567945424, 0.848048096156426, 0.8571673007021123,
+	0.8660254037844386, 0.8746197071393957, 0.8829475928589269, 0.8910065241883678,
+	0.898794046299167, 0.9063077870366499, 0.9135454576426009, 0.9205048534524404,
+	0.9271838545667874, 0.9335804264972017, 0.9396926207859083, 0.9455185755993167,
+	0.9510565162951535, 0.9563047559630354, 0.9612616959383189, 0.9659258262890683,
+	0.9702957262759965, 0.9743700647852352, 0.9781476007338056, 0.981627183447664,
+	0.984807753012208, 0.9876883405951378, 0.9902680687415704, 0.992546151641322,
+	0.9945218953682733, 0.9961946980917455, 0.9975640502598242, 0.9986295347545738,
+	0.9993908270190958, 0.9998476951563913, 1.0,
+};
+
+sincos_pair sincos_deg(int deg) {
+	unsigned d = (unsigned)(deg % 360 + 360) % 360;
+	unsigned r = d % 90;
+	real a = (real)sin_degrees[r];
+	real b = (real)sin_degrees[90 - r];
+	switch (d / 90) {
+	case 0: return (sincos_pair){ .s=a, .c=b };
+	case 1: return (sincos_pair){ .s=b, .c=-a };
+	case 2: return (sincos_pair){ .s=-a, .c=-b };
+	default: return (sincos_pair){ .s=-b, .c=a };
+	}
+}
+
+mat16* rotation_axis_angle(vec3 const* axis, real rad, mat16* out) {
+	if (axis && out) {
+		real n = tuple_len(VECTOR(axis->x, axis->y, axis->z));
+		if (real_equal(n, 0))
+			return nullptr;
+		real x = axis->x / n, y = axis->y / n, z = axis->z / n;
+		sincos_pair sc = sincos_rad(rad);
+		real t = 1 - sc.c;
+
+		*out = (mat16){
+			.m00=t * x * x + sc.c,     .m01=t * x * y - sc.s * z, .m02=t * x * z + sc.s * y,
+			.m10=t * x * y + sc.s * z, .m11=t * y * y + sc.c,     .m12=t * y * z - sc.s * x,
+			.m20=t * x * z - sc.s * y, .m21=t * y * z + sc.s * x, .m22=t * z * z + sc.c,
+			.m33=1,
+		};
+		return out;
+	}
+	return nullptr;
+}
+
+mat16* rotation_quat(quat const* q, mat16* out) {
+	if (q && out) {
+		real n = tuple_len_squared(*q);
+		if (real_equal(n, 0))
+			return nullptr;
+		real k = 2 / n;
+		real x = q->x, y = q->y, z = q->z, w = q->w;
+
+		*out = (mat16){
+			.m00=1 - k * (y * y + z * z), .m01=k * (x * y - w * z),     .m02=k * (x * z + w * y),
+			.m10=k * (x * y + w * z),     .m11=1 - k * (x * x + z * z), .m12=k * (y * z - w * x),
+			.m20=k * (x * z - w * y),     .m21=k * (y * z + w * x),     .m22=1 - k * (x * x + y * y),
+			.m33=1,
+		};
+		return out;
+	}
+	return nullptr;
+}
+
+mat12* mat12_from_mat16(mat16 const* a, mat12* out) {
+	if (a && out) {
+		if (!real_equal(a->m30, 0) || !real_equal(a->m31, 0)
+				|| !real_equal(a->m32, 0) || !real_equal(a->m33, 1))
+			return nullptr;
+		for (unsigned i = 0; i < 12; i++)
+			out->data[i] = a->data[i];
+		return out;
+	}
+	return nullptr;
+}
+
+mat16* mat16_from_mat12(mat12 const* a, mat16* out) {
+	if (a && out) {
+		for (unsigned i = 0; i < 12; i++)
+			out->data[i] = a->data[i];
+		out->m30 = out->m31 = out->m32 = 0;
+		out->m33 = 1;
+		return out;
+	}
+	return nullptr;
+}
+
+mat12* mat12_mul(mat12 const* a, mat12 const* b, mat12* c) {
+	if (a && b && c) {
+		mat12 r;
+		for (unsigned i = 0; i < 3; i++) {
+			real const* row = a->data + i * 4;
+			for (unsigned j = 0; j < 4; j++)
+				r.data[i*4+j] = row[0] * b->data[0*4+j]
+					+ row[1] * b->data[1*4+j]
+					+ row[2] * b->data[2*4+j];
+			r.data[i*4+3] += row[3];
+		}
+		*c = r;
+		return c;
+	}
+	return nullptr;
+}
+
+tuple* mat12_mul_by_tuple(mat12 const* a, tuple const* b, tuple* out) {
+	if (a && b && out) {
+		tuple t = *b;
+		out->x = a->m00 * t.x + a->m01 * t.y + a->m02 * t.z + a->m03 * t.w;
+		out->y = a->m10 * t.x + a->m11 * t.y + a->m12 * t.z + a->m13 * t.w;
+		out->z = a->m20 * t.x + a->m21 * t.y + a->m22 * t.z + a->m23 * t.w;
+		out->w = t.w;
 		return out;
+	}
+	return nullptr;
+}
+
+mat12* mat12_inverse(mat12 const* a, mat12* out) {
+	if (a && out) {
+		// Cofactors of the linear part; row 0 of them also gives the determinant.
+		real c00 = a->m11 * a->m22 - a->m12 * a->m21;
+		real c01 = a->m12 * a->m20 - a->m10 * a->m22;
+		real c02 = a->m10 * a->m21 - a->m11 * a->m20;
+		real det = a->m00 * c00 + a->m01 * c01 + a->m02 * c02;
+		if (real_equal(det, 0))
+			return nullptr;
+		real k = 1 / det;
 
+		mat12 r = {
+			.m00 = c00 * k,
+			.m01 = (a->m02 * a->m21 - a->m01 * a->m22) * k,
+			.m02 = (a->m01 * a->m12 - a->m02 * a->m11) * k,
+			.m10 = c01 * k,
+			.m11 = (a->m00 * a->m22 - a->m02 * a->m20) * k,
+			.m12 = (a->m02 * a->m10 - a->m00 * a->m12) * k,
+			.m20 = c02 * k,
+			.m21 = (a->m01 * a->m20 - a->m00 * a->m21) * k,
+			.m22 = (a->m00 * a->m11 - a->m01 * a->m10) * k,
+		};
+		r.m03 = -(r.m00 * a->m03 + r.m01 * a->m13 + r.m02 * a->m23);
+		r.m13 = -(r.m10 * a->m03 + r.m11 * a->m13 + r.m12 * a->m23);
+		r.m23 = -(r.m20 * a->m03 + r.m21 * a->m13 + r.m22 * a->m23);
+		*out = r;
+		return out;
 	}
 	return nullptr;
 }
-#undef EPSILON
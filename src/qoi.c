@@ -0,0 +1,94 @@
+#include <string.h>
+
+#include "headers/qoi.h"
+
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xc0
+#define QOI_OP_RGB 0xfe
+#define QOI_RUN_MAX 62
+
+// Colour hash of the format; the alpha channel is always 255.
+#define QOI_HASH(p) (((p)[0] * 3 + (p)[1] * 5 + (p)[2] * 7 + 255 * 11) % 64)
+
+static
+void put_u32_be(uint8_t* out, uint32_t v) {
+	out[0] = v >> 24;
+	out[1] = v >> 16;
+	out[2] = v >> 8;
+	out[3] = v;
+}
+
+void qoi_header(uint32_t w, uint32_t h, uint8_t out[static QOI_HEADER_SIZE]) {
+	memcpy(out, "qoif", 4);
+	put_u32_be(out + 4, w);
+	put_u32_be(out + 8, h);
+	out[12] = 3; // RGB.
+	out[13] = 0; // sRGB with linear alpha.
+}
+
+void qoi_enc_init(qoi_enc* e, uint8_t const* prev) {
+	if (e) {
+		*e = (qoi_enc){ };
+		if (prev) {
+			// The decoder has just indexed the preceding pixel.
+			memcpy(e->prev, prev, 3);
+			memcpy(e->index[QOI_HASH(prev)], prev, 3);
+			e->valid = 1ull << QOI_HASH(prev);
+		}
+	}
+}
+
+size_t qoi_flush(qoi_enc* e, uint8_t* out) {
+	if (!e || !e->run)
+		return 0;
+	out[0] = QOI_OP_RUN | (e->run - 1);
+	e->run = 0;
+	return 1;
+}
+
+size_t qoi_encode(qoi_enc* e, uint8_t const* restrict rgb, size_t n, uint8_t* restrict out) {
+	size_t len = 0;
+	for (size_t i = 0; i < n; i++, rgb += 3) {
+		if (rgb[0] == e->prev[0] && rgb[1] == e->prev[1] && rgb[2] == e->prev[2]) {
+			if (++e->run == QOI_RUN_MAX)
+				len += qoi_flush(e, out + len);
+			continue;
+		}
+		len += qoi_flush(e, out + len);
+
+		unsigned h = QOI_HASH(rgb);
+		if (e->valid >> h & 1 && memcmp(e->index[h], rgb, 3) == 0) {
+			out[len++] = QOI_OP_INDEX | h;
+		} else {
+			memcpy(e->index[h], rgb, 3);
+			e->valid |= 1ull << h;
+
+			int8_t dr = (int8_t)(rgb[0] - e->prev[0]);
+			int8_t dg = (int8_t)(rgb[1] - e->prev[1]);
+			int8_t db = (int8_t)(rgb[2] - e->prev[2]);
+			int8_t dr_dg = (int8_t)(dr - dg);
+			int8_t db_dg = (int8_t)(db - dg);
+
+			if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+				out[len++] = QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2);
+			} else if (dg >= -32 && dg <= 31 && dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+				out[len++] = QOI_OP_LUMA | (dg + 32);
+				out[len++] = (dr_dg + 8) << 4 | (db_dg + 8);
+			} else {
+				out[len++] = QOI_OP_RGB;
+				out[len++] = rgb[0];
+				out[len++] = rgb[1];
+				out[len++] = rgb[2];
+			}
+		}
+		memcpy(e->prev, rgb, 3);
+	}
+	return len;
+}
+
+void qoi_end(uint8_t out[static QOI_END_SIZE]) {
+	static uint8_t const marker[QOI_END_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+	memcpy(out, marker, QOI_END_SIZE);
+}
@@ -0,0 +1,130 @@
+#include "headers/qtransform.h"
+
+/*
+ * Hamilton product p * q: the rotation q followed by p.
+ */
+static
+quat quat_mul(quat p, quat q) {
+	return QUAT(
+		p.w * q.x + p.x * q.w + p.y * q.z - p.z * q.y,
+		p.w * q.y - p.x * q.z + p.y * q.w + p.z * q.x,
+		p.w * q.z + p.x * q.y - p.y * q.x + p.z * q.w,
+		p.w * q.w - p.x * q.x - p.y * q.y - p.z * q.z);
+}
+
+/*
+ * Rotates the vector part of `v` by the unit quaternion `q`, as
+ * v + 2w (u x v) + 2 u x (u x v) with u the vector part of q: two cross
+ * products instead of two quaternion products.
+ */
+static
+vec3 quat_rotate(quat q, vec3 v) {
+	vec3 u = VECTOR(q.x, q.y, q.z);
+	vec3 t = tuple_scale(tuple_cross(u, v), 2);
+	return tuple_add(tuple_add(v, tuple_scale(t, q.w)), tuple_cross(u, t));
+}
+
+static
+vec3 translation_of(qtransform const* a) {
+	return VECTOR(a->translation[0], a->translation[1], a->translation[2]);
+}
+
+qtransform* qtransform_from_mat16(mat16 const* a, qtransform* out) {
+	if (a && out) {
+		if (!real_equal(a->m30, 0) || !real_equal(a->m31, 0)
+				|| !real_equal(a->m32, 0) || !real_equal(a->m33, 1))
+			return nullptr;
+
+		vec3 c0 = VECTOR(a->m00, a->m10, a->m20);
+		vec3 c1 = VECTOR(a->m01, a->m11, a->m21);
+		vec3 c2 = VECTOR(a->m02, a->m12, a->m22);
+		real s = tuple_len(c0);
+		// Columns of a scaled rotation: equal lengths, orthogonal, right-handed.
+		if (real_equal(s, 0) || !real_equal(tuple_len(c1), s) || !real_equal(tuple_len(c2), s)
+				|| !real_equal(tuple_dot(c0, c1) / (s * s), 0)
+				|| !real_equal(tuple_dot(c0, c2) / (s * s), 0)
+				|| !real_equal(tuple_dot(c1, c2) / (s * s), 0)
+				|| tuple_dot(tuple_cross(c0, c1), c2) < 0)
+			return nullptr;
+
+		// Shepperd's method on R = M / s: pivot on the largest diagonal term.
+		real r00 = a->m00 / s, r01 = a->m01 / s, r02 = a->m02 / s;
+		real r10 = a->m10 / s, r11 = a->m11 / s, r12 = a->m12 / s;
+		real r20 = a->m20 / s, r21 = a->m21 / s, r22 = a->m22 / s;
+		real trace = r00 + r11 + r22;
+		quat q;
+		if (trace > 0) {
+			real k = 2 * sqrt(1 + trace);
+			q = QUAT((r21 - r12) / k, (r02 - r20) / k, (r10 - r01) / k, k / 4);
+		} else if (r00 > r11 && r00 > r22) {
+			real k = 2 * sqrt(1 + r00 - r11 - r22);
+			q = QUAT(k / 4, (r01 + r10) / k, (r02 + r20) / k, (r21 - r12) / k);
+		} else if (r11 > r22) {
+			real k = 2 * sqrt(1 + r11 - r00 - r22);
+			q = QUAT((r01 + r10) / k, k / 4, (r12 + r21) / k, (r02 - r20) / k);
+		} else {
+			real k = 2 * sqrt(1 + r22 - r00 - r11);
+			q = QUAT((r02 + r20) / k, (r12 + r21) / k, k / 4, (r10 - r01) / k);
+		}
+
+		*out = (qtransform){
+			.rotation=tuple_unit(q),
+			.translation={ a->m03, a->m13, a->m23 },
+			.scale=s,
+		};
+		return out;
+	}
+	return nullptr;
+}
+
+mat16* mat16_from_qtransform(qtransform const* a, mat16* out) {
+	if (a && out && rotation_quat(&a->rotation, out)) {
+		for (unsigned r = 0; r < 3; r++) {
+			for (unsigned c = 0; c < 3; c++)
+				out->data[r * 4 + c] *= a->scale;
+			out->data[r * 4 + 3] = a->translation[r];
+		}
+		return out;
+	}
+	return nullptr;
+}
+
+qtransform* qtransform_compose(qtransform const* a, qtransform const* b, qtransform* out) {
+	if (a && b && out) {
+		vec3 t = tuple_add(translation_of(a),
+				tuple_scale(quat_rotate(a->rotation, translation_of(b)), a->scale));
+		*out = (qtransform){
+			.rotation=quat_mul(a->rotation, b->rotation),
+			.translation={ t.x, t.y, t.z },
+			.scale=a->scale * b->scale,
+		};
+		return out;
+	}
+	return nullptr;
+}
+
+qtransform* qtransform_inverse(qtransform const* a, qtransform* out) {
+	if (a && out) {
+		quat conj = QUAT(-a->rotation.x, -a->rotation.y, -a->rotation.z, a->rotation.w);
+		real s = 1 / a->scale;
+		vec3 t = tuple_scale(quat_rotate(conj, translation_of(a)), -s);
+		*out = (qtransform){
+			.rotation=conj,
+			.translation={ t.x, t.y, t.z },
+			.scale=s,
+		};
+		return out;
+	}
+	return nullptr;
+}
+
+tuple* qtransform_tuple(qtransform const* a, tuple const* b, tuple* out) {
+	if (a && b && out) {
+		real w = b->w;
+		vec3 v = tuple_scale(quat_rotate(a->rotation, VECTOR(b->x, b->y, b->z)), a->scale);
+		*out = tuple_add(v, tuple_scale(translation_of(a), w));
+		out->w = w;
+		return out;
+	}
+	return nullptr;
+}
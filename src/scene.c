@@ -0,0 +1,106 @@
+#include "headers/scene.h"
+
+/*
+ * Marks `node` and its subtree dirty. Dirty nodes only ever have dirty
+ * descendants, so the walk stops at the first node already marked.
+ */
+static
+void mark_dirty(scene_node* node) {
+	if (node->dirty)
+		return;
+	node->dirty = true;
+	for (scene_node* c = node->first_child; c; c = c->next_sibling)
+		mark_dirty(c);
+}
+
+/*
+ * Recomputes the world transform of `node`, whose parent (if any) is
+ * already up to date.
+ */
+static
+void refresh(scene_node* node) {
+	if (node->parent) {
+		transform const* p = &node->parent->world;
+		mat16_mul(&p->forward, &node->local.forward, &node->world.forward);
+		mat16_mul(&node->local.inverse, &p->inverse, &node->world.inverse);
+		node->world.inverse_transpose = node->world.inverse;
+		mat16_transpose(&node->world.inverse_transpose);
+	} else {
+		node->world = node->local;
+	}
+	node->dirty = false;
+}
+
+scene_node* scene_node_init(scene_node* node, mat16 const* m) {
+	if (node && m) {
+		transform local;
+		if (!transform_set(&local, m))
+			return nullptr;
+		*node = (scene_node){ .local=local, .dirty=true };
+		return node;
+	}
+	return nullptr;
+}
+
+scene_node* scene_node_set_local(scene_node* node, mat16 const* m) {
+	if (node && transform_set(&node->local, m)) {
+		mark_dirty(node);
+		return node;
+	}
+	return nullptr;
+}
+
+scene_node* scene_node_detach(scene_node* node) {
+	if (node) {
+		scene_node* p = node->parent;
+		if (p) {
+			scene_node** link = &p->first_child;
+			while (*link != node)
+				link = &(*link)->next_sibling;
+			*link = node->next_sibling;
+			node->parent = nullptr;
+			node->next_sibling = nullptr;
+		}
+		mark_dirty(node);
+		return node;
+	}
+	return nullptr;
+}
+
+scene_node* scene_node_attach(scene_node* parent, scene_node* child) {
+	if (parent && child && parent != child) {
+		scene_node_detach(child);
+		scene_node** link = &parent->first_child;
+		while (*link)
+			link = &(*link)->next_sibling;
+		*link = child;
+		child->parent = parent;
+		return child;
+	}
+	return nullptr;
+}
+
+transform const* scene_node_world(scene_node* node) {
+	if (node) {
+		if (node->dirty) {
+			if (node->parent)
+				scene_node_world(node->parent);
+			refresh(node);
+		}
+		return &node->world;
+	}
+	return nullptr;
+}
+
+size_t scene_update(scene_node* root) {
+	size_t n = 0;
+	if (root) {
+		if (root->dirty) {
+			scene_node_world(root);
+			n++;
+		}
+		for (scene_node* c = root->first_child; c; c = c->next_sibling)
+			n += scene_update(c);
+	}
+	return n;
+}
@@ -0,0 +1,72 @@
+#include "headers/sphere.h"
+
+sphere_batch* sphere_batch_set(sphere_batch* b, unsigned i, point3 const* center, real radius) {
+	if (b && center && radius != 0 && i < PACKET_WIDTH) {
+		mat12 forward = {
+			.m00=radius, .m03=center->x,
+			.m11=radius, .m13=center->y,
+			.m22=radius, .m23=center->z,
+		};
+		return sphere_batch_set_transform(b, i, &forward);
+	}
+	return nullptr;
+}
+
+sphere_batch* sphere_batch_set_transform(sphere_batch* b, unsigned i, mat12 const* forward) {
+	mat12 inverse;
+	if (b && forward && i < PACKET_WIDTH && mat12_inverse(forward, &inverse)) {
+		for (unsigned k = 0; k < 12; k++)
+			b->inverse[k][i] = inverse.data[k];
+		b->active[i] = -1;
+		return b;
+	}
+	return nullptr;
+}
+
+lane_mask sphere_batch_intersect(sphere_batch const* b, ray const* r, real_lanes* t0, real_lanes* t1) {
+	if (!b || !r || !t0 || !t1)
+		return mask_first(0);
+
+	// The ray in every sphere's object space: o = M^-1 orig, d = M^-1 dir.
+	real_lanes const* m = b->inverse;
+	real_lanes ox = m[0] * r->orig.x + m[1] * r->orig.y + m[2] * r->orig.z + m[3];
+	real_lanes oy = m[4] * r->orig.x + m[5] * r->orig.y + m[6] * r->orig.z + m[7];
+	real_lanes oz = m[8] * r->orig.x + m[9] * r->orig.y + m[10] * r->orig.z + m[11];
+	real_lanes dx = m[0] * r->dir.x + m[1] * r->dir.y + m[2] * r->dir.z;
+	real_lanes dy = m[4] * r->dir.x + m[5] * r->dir.y + m[6] * r->dir.z;
+	real_lanes dz = m[8] * r->dir.x + m[9] * r->dir.y + m[10] * r->dir.z;
+
+	// a t^2 + 2 h t + c = 0, with the halved linear term.
+	real_lanes a = dx * dx + dy * dy + dz * dz;
+	real_lanes h = dx * ox + dy * oy + dz * oz;
+	real_lanes c = ox * ox + oy * oy + oz * oz - 1;
+	real_lanes disc = h * h - a * c;
+
+	lane_mask hit = b->active & (disc >= 0) & (a > 0);
+	real_lanes root = lanes_sqrt(lanes_select(hit, disc, lanes_splat(0)));
+	real_lanes inv_a = 1 / lanes_select(hit, a, lanes_splat(1));
+	real_lanes miss = lanes_splat(INFINITY);
+	*t0 = lanes_select(hit, (-h - root) * inv_a, miss);
+	*t1 = lanes_select(hit, (-h + root) * inv_a, miss);
+	return hit;
+}
+
+real spheres_closest_hit(sphere_batch const* b, size_t n, ray const* r, size_t* index) {
+	real best = INFINITY;
+	if (b && r)
+		for (size_t j = 0; j < n; j++) {
+			real_lanes t0, t1;
+			if (!mask_any(sphere_batch_intersect(&b[j], r, &t0, &t1)))
+				continue;
+			// Nearest root in front of the origin; misses are already infinite.
+			real_lanes zero = lanes_splat(0);
+			real_lanes t = lanes_select(t0 > zero, t0, lanes_select(t1 > zero, t1, lanes_splat(INFINITY)));
+			for (unsigned i = 0; i < PACKET_WIDTH; i++)
+				if (t[i] < best) {
+					best = t[i];
+					if (index)
+						*index = j * PACKET_WIDTH + i;
+				}
+		}
+	return best;
+}
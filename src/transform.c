@@ -0,0 +1,45 @@
+#include "headers/transform.h"
+
+transform* transform_set(transform* t, mat16 const* m) {
+	if (t && m) {
+		mat16 inverse;
+		if (!mat16_inverse(m, &inverse))
+			return nullptr;
+		t->forward = *m;
+		t->inverse = inverse;
+		t->inverse_transpose = inverse;
+		mat16_transpose(&t->inverse_transpose);
+		return t;
+	}
+	return nullptr;
+}
+
+transform* transform_compose(transform* t, mat16 const* m) {
+	return t && m ? transform_set(t, MAT16_MUL(m, &t->forward)) : nullptr;
+}
+
+tuple* transform_tuple(transform const* t, tuple const* a, tuple* out) {
+	return t ? mat16_mul_by_tuple(&t->forward, a, out) : nullptr;
+}
+
+vec3* transform_normal(transform const* t, vec3 const* n, vec3* out) {
+	if (t && n && out) {
+		vec3 world;
+		mat16_mul_by_tuple(&t->inverse_transpose, n, &world);
+		world.w = 0;
+		*out = tuple_unit(world);
+		return out;
+	}
+	return nullptr;
+}
+
+ray* transform_ray_to_object(transform const* t, ray const* r, ray* out) {
+	if (t && r && out) {
+		ray local;
+		mat16_mul_by_tuple(&t->inverse, &r->orig, &local.orig);
+		mat16_mul_by_tuple(&t->inverse, &r->dir, &local.dir);
+		*out = local;
+		return out;
+	}
+	return nullptr;
+}
@@ -0,0 +1,121 @@
+#include "headers/tuple_array.h"
+
+tuple* tuple_array_add(tuple const* restrict a, tuple const* restrict b, size_t n,
+		tuple* restrict out) {
+	if (a && b && out) {
+		for (size_t i = 0; i < n; i++)
+			out[i].v = a[i].v + b[i].v;
+		return out;
+	}
+	return nullptr;
+}
+
+tuple* tuple_array_add_inplace(tuple* restrict a, tuple const* restrict b, size_t n) {
+	if (a && b) {
+		for (size_t i = 0; i < n; i++)
+			a[i].v += b[i].v;
+		return a;
+	}
+	return nullptr;
+}
+
+tuple* tuple_array_offset(tuple const* restrict a, tuple t, size_t n, tuple* restrict out) {
+	if (a && out) {
+		for (size_t i = 0; i < n; i++)
+			out[i].v = a[i].v + t.v;
+		return out;
+	}
+	return nullptr;
+}
+
+tuple* tuple_array_offset_inplace(tuple* a, tuple t, size_t n) {
+	if (a) {
+		for (size_t i = 0; i < n; i++)
+			a[i].v += t.v;
+		return a;
+	}
+	return nullptr;
+}
+
+tuple* tuple_array_scale(tuple const* restrict a, real t, size_t n, tuple* restrict out) {
+	if (a && out) {
+		for (size_t i = 0; i < n; i++)
+			out[i].v = a[i].v * t;
+		return out;
+	}
+	return nullptr;
+}
+
+tuple* tuple_array_scale_inplace(tuple* a, real t, size_t n) {
+	if (a) {
+		for (size_t i = 0; i < n; i++)
+			a[i].v *= t;
+		return a;
+	}
+	return nullptr;
+}
+
+vec3* tuple_array_normalize(vec3 const* restrict a, size_t n, vec3* restrict out) {
+	if (a && out) {
+		for (size_t i = 0; i < n; i++)
+			out[i] = tuple_unit(a[i]);
+		return out;
+	}
+	return nullptr;
+}
+
+vec3* tuple_array_normalize_inplace(vec3* a, size_t n) {
+	if (a) {
+		for (size_t i = 0; i < n; i++)
+			a[i] = tuple_unit(a[i]);
+		return a;
+	}
+	return nullptr;
+}
+
+vec3* tuple_array_normalize_fast(vec3 const* restrict a, size_t n, vec3* restrict out) {
+	if (a && out) {
+		for (size_t i = 0; i < n; i++)
+			out[i] = tuple_unit_fast(a[i]);
+		return out;
+	}
+	return nullptr;
+}
+
+vec3* tuple_array_normalize_fast_inplace(vec3* a, size_t n) {
+	if (a) {
+		for (size_t i = 0; i < n; i++)
+			a[i] = tuple_unit_fast(a[i]);
+		return a;
+	}
+	return nullptr;
+}
+
+real* tuple_array_dot(tuple const* restrict a, tuple const* restrict b, size_t n,
+		real* restrict out) {
+	if (a && b && out) {
+		for (size_t i = 0; i < n; i++)
+			out[i] = tuple_dot(a[i], b[i]);
+		return out;
+	}
+	return nullptr;
+}
+
+vec3* tuple_array_cross(vec3 const* restrict a, vec3 const* restrict b, size_t n,
+		vec3* restrict out) {
+	if (a && b && out) {
+		for (size_t i = 0; i < n; i++)
+			out[i] = tuple_cross(a[i], b[i]);
+		return out;
+	}
+	return nullptr;
+}
+
+vec3* tuple_array_cross_inplace(vec3* restrict a, vec3 const* restrict b, size_t n) {
+	if (a && b) {
+		for (size_t i = 0; i < n; i++)
+			a[i] = tuple_cross(a[i], b[i]);
+		return a;
+	}
+	return nullptr;
+}
@@ -7,10 +7,7 @@ vec3* unit_vec3(vec3 const* u, vec3* out) {
 
 tuple* sub(tuple const* u, tuple const* v, tuple* out) {
 	if (u && v && out) {
-		out->x = u->x - v->x;
-		out->y = u->y - v->y;
-		out->z = u->z - v->z;
-		out->w = u->w - v->w;
+		out->v = u->v - v->v;
 		return out;
 	}
 	return nullptr;
@@ -18,10 +15,7 @@ tuple* sub(tuple const* u, tuple const* v, tuple* out) {
 
 tuple* add(tuple const* u, tuple const* v, tuple* out) {
 	if (u && v && out) {
-		out->x = u->x + v->x;
-		out->y = u->y + v->y;
-		out->z = u->z + v->z;
-		out->w = u->w + v->w;
+		out->v = u->v + v->v;
 		return out;
 	}
 	return nullptr;
@@ -1,8 +1,10 @@
 #include "../src/headers/canvas.h"
+#include "../src/headers/qoi.h"
 
 #include "test_main.h"
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 
 #ifndef EPSILON
 # define EPSILON 1E-5
@@ -61,7 +63,7 @@ static
 void test_canvas_ppm_header_construction(void) {
 	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(5, 3);
 
-	char* ppm_filename = canvas_2_ppm(c);
+	char* ppm_filename = canvas_2_ppm(c, IMG_P3);
 	assert(ppm_filename != NULL);
 	__attribute__((cleanup(close_file)))FILE* fp = fopen(ppm_filename, "rb");
 	assert(fp != NULL);
@@ -99,7 +101,7 @@ static
 void test_canvas_ppm_terminated_by_newline(void) {
 	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(5, 3);
 
-	char* ppm_filename = canvas_2_ppm(c);
+	char* ppm_filename = canvas_2_ppm(c, IMG_P3);
 	assert(ppm_filename != NULL);
 	__attribute__((cleanup(close_file)))FILE* fp = fopen(ppm_filename, "rb");
 	assert(fp != NULL);
@@ -123,7 +125,7 @@ void test_canvas_ppm_pixel_data_construction(void) {
 	c = write_pixel(c, 2, 1, &green);
 	c = write_pixel(c, 4, 2, &blue);
 
-	char* ppm_filename = canvas_2_ppm(c);
+	char* ppm_filename = canvas_2_ppm(c, IMG_P3);
 	assert(ppm_filename != NULL);
 	__attribute__((cleanup(close_file)))FILE* fp = fopen(ppm_filename, "rb");
 	assert(fp != NULL);
@@ -153,12 +155,460 @@ void test_canvas_ppm_pixel_data_construction(void) {
 	putchar('.');
 }
 
+static
+void test_canvas_p6_header_construction(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(5, 3);
+
+	char* ppm_filename = canvas_2_ppm(c, IMG_P6);
+	assert(ppm_filename != NULL);
+	__attribute__((cleanup(close_file)))FILE* fp = fopen(ppm_filename, "rb");
+	assert(fp != NULL);
+
+	char header[] = "P6\n5 3\n255\n";
+	char buffer[sizeof header] = { };
+	assert(fread(buffer, 1, sizeof header - 1, fp) == sizeof header - 1);
+	assert(strcmp(buffer, header) == 0);
+
+	fseek(fp, 0, SEEK_END);
+	assert(ftell(fp) == (long)(sizeof header - 1 + 5 * 3 * 3));
+	putchar('.');
+}
+
+static
+void test_canvas_p6_pixel_data_construction(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(5, 3);
+
+	col3 red = COLOUR(1.5f, 0, 0);
+	col3 green = COLOUR(0, 0.5, 0);
+	col3 blue = COLOUR(-0.5f, 0, 1);
+
+	c = write_pixel(c, 0, 0, &red);
+	c = write_pixel(c, 2, 1, &green);
+	c = write_pixel(c, 4, 2, &blue);
+
+	char* ppm_filename = canvas_2_ppm(c, IMG_P6);
+	assert(ppm_filename != NULL);
+	__attribute__((cleanup(close_file)))FILE* fp = fopen(ppm_filename, "rb");
+	assert(fp != NULL);
+
+	fseek(fp, sizeof "P6\n5 3\n255\n" - 1, SEEK_SET);
+	unsigned char raster[5 * 3 * 3];
+	assert(fread(raster, 1, sizeof raster, fp) == sizeof raster);
+
+	unsigned char const* p = &raster[0];
+	assert(p[0] == 255 && p[1] == 0 && p[2] == 0);
+	p = &raster[3 * (1 * 5 + 2)];
+	assert(p[0] == 0 && p[1] == 128 && p[2] == 0);
+	p = &raster[3 * (2 * 5 + 4)];
+	assert(p[0] == 0 && p[1] == 0 && p[2] == 255);
+	p = &raster[3 * 1];
+	assert(p[0] == 0 && p[1] == 0 && p[2] == 0);
+
+	// Not a PPM encoding: `image.ppm` is left alone.
+	errno = 0;
+	assert(canvas_2_ppm(c, IMG_QOI) == NULL && errno == EINVAL);
+	assert(canvas_2_ppm(c, IMG_PFM) == NULL);
+
+	putchar('.');
+}
+
+static
+unsigned char reference_quantize(float x) {
+	float v = ceilf(x * MAX_COL_VAL);
+	if (!(v > 0))
+		return 0;
+	return v > MAX_COL_VAL ? MAX_COL_VAL : (unsigned char)v;
+}
+
+static
+void test_col3_quantize_matches_scalar(void) {
+	// An odd pixel count exercises the vector body and the scalar tail.
+	enum { N = 1001 };
+	col3 pixels[N];
+	float* f = &pixels[0].red;
+	float const special[] = {
+		0.0f, -0.0f, -0.5f, 1.0f, 1.5f, 0.5f, 1.0f / 255, 254.5f / 255,
+		1e-30f, -1e-30f, NAN, -NAN, INFINITY, -INFINITY, 0.999999f,
+	};
+	unsigned seed = 1;
+	for (unsigned i = 0; i < 3 * N; i++) {
+		if (i < sizeof special / sizeof special[0]) {
+			f[i] = special[i];
+		} else {
+			seed = seed * 1103515245u + 12345u;
+			f[i] = (float)(seed >> 8) / (1u << 24) * 1.2f - 0.1f;
+		}
+	}
+
+	unsigned char out[3 * N];
+	col3_quantize(pixels, N, out);
+	for (unsigned i = 0; i < 3 * N; i++)
+		assert(out[i] == reference_quantize(f[i]));
+
+	putchar('.');
+}
+
+static
+void test_canvas_export_mem_size_query(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(5, 3);
+	c = write_pixel(c, 0, 0, &COLOUR(1.5f, 0, 0));
+	c = write_pixel(c, 4, 2, &COLOUR(-0.5f, 0, 1));
+
+	size_t size = canvas_export_size(c, IMG_P6);
+	assert(size == sizeof "P6\n5 3\n255\n" - 1 + 5 * 3 * 3);
+
+	unsigned char buf[128];
+	assert(canvas_export_mem(c, IMG_P6, buf, size - 1) == 0);
+	assert(canvas_export_mem(c, IMG_P6, buf, sizeof buf) == size);
+	assert(memcmp(buf, "P6\n5 3\n255\n", 11) == 0);
+	assert(buf[11] == 255 && buf[12] == 0 && buf[13] == 0);
+	assert(buf[size - 3] == 0 && buf[size - 2] == 0 && buf[size - 1] == 255);
+
+	putchar('.');
+}
+
+static
+void test_canvas_export_mem_p3(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(2, 1);
+	c = write_pixel(c, 0, 0, &COLOUR(1.5f, 0, 0));
+	c = write_pixel(c, 1, 0, &COLOUR(0, 0.5f, 0.05f));
+
+	char const expected[] = "P3\n2 1\n255\n255 0 0\n0 128 13\n";
+	assert(canvas_export_size(c, IMG_P3) == sizeof expected - 1);
+
+	char buf[sizeof expected] = { };
+	assert(canvas_export_mem(c, IMG_P3, buf, sizeof buf) == sizeof expected - 1);
+	assert(strcmp(buf, expected) == 0);
+
+	putchar('.');
+}
+
+static
+void test_canvas_export_fd_matches_mem(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(7, 4);
+	for (uint16_t y = 0; y < 4; y++)
+		for (uint16_t x = 0; x < 7; x++)
+			write_pixel(c, x, y, &COLOUR(x / 7.0f, y / 4.0f, 0.5f));
+
+	unsigned char expected[256];
+	size_t size = canvas_export_mem(c, IMG_P6, expected, sizeof expected);
+	assert(size > 0);
+
+	int fds[2];
+	assert(pipe(fds) == 0);
+	assert(canvas_export_fd(c, IMG_P6, fds[1]));
+	close(fds[1]);
+
+	unsigned char got[256];
+	size_t len = 0;
+	ssize_t n;
+	while ((n = read(fds[0], got + len, sizeof got - len)) > 0)
+		len += (size_t)n;
+	close(fds[0]);
+
+	assert(len == size);
+	assert(memcmp(got, expected, size) == 0);
+	putchar('.');
+}
+
+static
+void test_canvas_export_file_to_path(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(3, 2);
+	char const* path = "test_export.ppm";
+
+	assert(canvas_export_file(c, IMG_P6, path) == path);
+	__attribute__((cleanup(close_file)))FILE* fp = fopen(path, "rb");
+	assert(fp != NULL);
+	fseek(fp, 0, SEEK_END);
+	assert((size_t)ftell(fp) == canvas_export_size(c, IMG_P6));
+	remove(path);
+
+	assert(canvas_export_file(c, IMG_P6, "no/such/dir/image.ppm") == NULL);
+	putchar('.');
+}
+
+static
+void test_canvas_mapped_writes_pfm_in_place(void) {
+	char const* path = "test_mapped.pfm";
+	canvas* c = canvas_new_mapped(5, 3, path);
+	assert(c != NULL);
+	assert(c->width == 5 && c->height == 3);
+	assert(float_equal(pixel_at(c, 4, 2)->red, 0.0f));
+
+	c = write_pixel(c, 0, 0, &COLOUR(1.0f, 0.25f, 0.5f));
+	c = write_pixel(c, 4, 2, &COLOUR(0, 0, -2.0f));
+	assert(float_equal(pixel_at(c, 0, 0)->green, 0.25f));
+	assert(canvas_sync(c));
+
+	// Exporting a mapped canvas yields the same image as a heap canvas.
+	__attribute__((cleanup(canvas_delete)))canvas* h = canvas_new(5, 3);
+	h = write_pixel(h, 0, 0, &COLOUR(1.0f, 0.25f, 0.5f));
+	h = write_pixel(h, 4, 2, &COLOUR(0, 0, -2.0f));
+	unsigned char a[64], b[64];
+	size_t size = canvas_export_mem(c, IMG_P6, a, sizeof a);
+	assert(size > 0 && canvas_export_mem(h, IMG_P6, b, sizeof b) == size);
+	assert(memcmp(a, b, size) == 0);
+	canvas_delete(&c);
+	assert(c == NULL);
+
+	__attribute__((cleanup(close_file)))FILE* fp = fopen(path, "rb");
+	assert(fp != NULL);
+	unsigned w, hgt;
+	float scale;
+	assert(fscanf(fp, "PF %u %u %f", &w, &hgt, &scale) == 3);
+	assert(w == 5 && hgt == 3 && float_equal(scale, -1.0f));
+	assert(fgetc(fp) == '\n');
+
+	float raster[5 * 3 * 3];
+	assert(fread(raster, sizeof(float), 5 * 3 * 3, fp) == 5 * 3 * 3);
+	assert(fgetc(fp) == EOF);
+	// PFM rows run bottom to top: (0, 0) is in the last row.
+	float const* p = &raster[3 * (2 * 5 + 0)];
+	assert(float_equal(p[0], 1.0f) && float_equal(p[1], 0.25f) && float_equal(p[2], 0.5f));
+	p = &raster[3 * (0 * 5 + 4)];
+	assert(float_equal(p[2], -2.0f));
+	remove(path);
+
+	assert(canvas_new_mapped(5, 3, "no/such/dir/image.pfm") == NULL);
+	putchar('.');
+}
+
+static
+void test_canvas_wider_than_16_bits(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(100000, 2);
+	assert(c != NULL);
+	assert(c->width == 100000);
+
+	c = write_pixel(c, 99999, 1, &COLOUR(0, 1.0f, 0));
+	assert(float_equal(c->pixels[2 * 100000 - 1].green, 1.0f));
+	assert(float_equal(pixel_at(c, 99999, 1)->green, 1.0f));
+	assert(pixel_at(c, 100000, 1) == NULL);
+
+	putchar('.');
+}
+
+static
+void test_canvas_size_overflow(void) {
+	size_t size;
+	assert(canvas_raster_size(1000, 1000, &size) && size == 1000 * 1000 * sizeof(col3));
+	assert(!canvas_raster_size(UINT32_MAX, UINT32_MAX, &size));
+
+	errno = 0;
+	assert(canvas_new(UINT32_MAX, UINT32_MAX) == NULL);
+	assert(errno == EOVERFLOW);
+	assert(canvas_new_mapped(UINT32_MAX, UINT32_MAX, "test_overflow.pfm") == NULL);
+
+	putchar('.');
+}
+
+static
+col3 gradient(uint32_t x, uint32_t y) {
+	return COLOUR(x / 5.0f, y / 7.0f, (x + y) % 2 ? 1.0f : 0.0f);
+}
+
+static
+void test_canvas_stream_matches_export(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(5, 7);
+	for (uint32_t y = 0; y < 7; y++)
+		for (uint32_t x = 0; x < 5; x++) {
+			col3 colour = gradient(x, y);
+			write_pixel(c, x, y, &colour);
+		}
+
+	for (img_fmt fmt = IMG_P6; fmt <= IMG_PFM; fmt++) {
+		char const* path = "test_stream.ppm";
+		canvas_stream* s = canvas_stream_open_file(5, 7, 3, fmt, path);
+		assert(s != NULL);
+
+		// Bands of 3, 3 and 1 scanlines.
+		canvas* band;
+		uint32_t y0, bands = 0;
+		while ((band = canvas_stream_band(s, &y0))) {
+			assert(y0 == 3 * bands);
+			assert(band->height == (bands < 2 ? 3 : 1));
+			assert(float_equal(pixel_at(band, 1, 0)->red, 0.0f));
+			for (uint32_t y = 0; y < band->height; y++)
+				for (uint32_t x = 0; x < band->width; x++) {
+					col3 colour = gradient(x, y0 + y);
+					write_pixel(band, x, y, &colour);
+				}
+			assert(canvas_stream_commit(s));
+			++bands;
+		}
+		assert(bands == 3);
+		assert(!canvas_stream_commit(s));
+		assert(canvas_stream_close(&s));
+		assert(s == NULL);
+
+		char expected[512], got[512];
+		size_t size = canvas_export_mem(c, fmt, expected, sizeof expected);
+		assert(size > 0);
+		__attribute__((cleanup(close_file)))FILE* fp = fopen(path, "rb");
+		assert(fp != NULL);
+		assert(fread(got, 1, sizeof got, fp) == size);
+		assert(memcmp(got, expected, size) == 0);
+		remove(path);
+	}
+
+	putchar('.');
+}
+
+static
+void test_canvas_stream_qoi_run_across_bands(void) {
+	// The first band is one black run, left open at its end; the second
+	// band is all QOI_OP_RGB chunks, so it needs the full QOI_PIXEL_MAX
+	// bytes per pixel on top of the byte that closes the run.
+	col3 const rows[2][4] = {
+		{ COLOUR(0, 0, 0), COLOUR(0, 0, 0), COLOUR(0, 0, 0), COLOUR(0, 0, 0) },
+		{ COLOUR(0.5f, 0, 0), COLOUR(0, 0.5f, 0), COLOUR(0, 0, 0.5f), COLOUR(0.5f, 0.5f, 0) },
+	};
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(4, 2);
+	char const* path = "test_stream.qoi";
+	canvas_stream* s = canvas_stream_open_file(4, 2, 1, IMG_QOI, path);
+	assert(c != NULL && s != NULL);
+
+	canvas* band;
+	uint32_t y0;
+	while ((band = canvas_stream_band(s, &y0))) {
+		for (uint32_t x = 0; x < 4; x++) {
+			col3 colour = rows[y0][x];
+			write_pixel(band, x, 0, &colour);
+			write_pixel(c, x, y0, &colour);
+		}
+		assert(canvas_stream_commit(s));
+	}
+	assert(canvas_stream_close(&s));
+
+	uint8_t expected[64], got[64];
+	size_t size = canvas_export_mem(c, IMG_QOI, expected, sizeof expected);
+	assert(size == QOI_HEADER_SIZE + 1 + QOI_PIXEL_MAX * 4 + QOI_END_SIZE);
+	__attribute__((cleanup(close_file)))FILE* fp = fopen(path, "rb");
+	assert(fp != NULL);
+	assert(fread(got, 1, sizeof got, fp) == size);
+	assert(memcmp(got, expected, size) == 0);
+	remove(path);
+
+	uint8_t decoded[3 * 4 * 2], quantized[3 * 4 * 2];
+	assert(qoi_decode(got, size, 4, 2, decoded));
+	col3_quantize(&rows[0][0], 8, quantized);
+	assert(memcmp(decoded, quantized, sizeof decoded) == 0);
+	putchar('.');
+}
+
+static
+void test_canvas_stream_incomplete(void) {
+	int fds[2];
+	assert(pipe(fds) == 0);
+	canvas_stream* s = canvas_stream_open(4, 4, 2, IMG_P6, fds[1]);
+	assert(s != NULL);
+	assert(canvas_stream_band(s, NULL) != NULL);
+	assert(canvas_stream_commit(s));
+	assert(!canvas_stream_close(&s));
+	close(fds[0]);
+	close(fds[1]);
+
+	assert(canvas_stream_open(4, 4, 0, IMG_P6, 1) == NULL);
+	assert(pipe(fds) == 0);
+	assert(canvas_stream_open(4, 4, 2, IMG_PFM, fds[1]) == NULL);
+	close(fds[0]);
+	close(fds[1]);
+	putchar('.');
+}
+
+static
+void test_canvas_tiled_layout(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* t = canvas_new_tiled(13, 10);
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(13, 10);
+	assert(t != NULL && t->width == 13 && t->height == 10);
+	assert(t->flags & CANVAS_TILED);
+
+	for (uint32_t y = 0; y < 10; y++)
+		for (uint32_t x = 0; x < 13; x++) {
+			col3 colour = gradient(x, y);
+			write_pixel(t, x, y, &colour);
+			write_pixel(c, x, y, &colour);
+		}
+
+	// (9, 1) sits in the second tile of the first tile row.
+	assert(pixel_at(t, 9, 1) == &t->pixels[CANVAS_TILE * CANVAS_TILE + CANVAS_TILE + 1]);
+	assert(float_equal(pixel_at(t, 12, 9)->green, 9 / 7.0f));
+	assert(pixel_at(t, 13, 0) == NULL);
+
+	for (img_fmt fmt = IMG_P6; fmt <= IMG_PFM; fmt++) {
+		char expected[4096], got[4096];
+		size_t size = canvas_export_mem(c, fmt, expected, sizeof expected);
+		assert(size > 0);
+		assert(canvas_export_size(t, fmt) == size);
+		assert(canvas_export_mem(t, fmt, got, sizeof got) == size);
+		assert(memcmp(got, expected, size) == 0);
+	}
+
+	putchar('.');
+}
+
+static
+void test_canvas_export_pfm(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(3, 2);
+	c = write_pixel(c, 0, 0, &COLOUR(2.5f, -1.0f, 0.125f));
+	c = write_pixel(c, 2, 1, &COLOUR(0, 0, 7.0f));
+
+	char const header[] = "PF\n3 2\n-1.0\n";
+	size_t size = canvas_export_size(c, IMG_PFM);
+	assert(size == sizeof header - 1 + 3 * 2 * sizeof(col3));
+
+	unsigned char buf[128];
+	assert(canvas_export_mem(c, IMG_PFM, buf, sizeof buf) == size);
+	assert(memcmp(buf, header, sizeof header - 1) == 0);
+
+	// Values are not clamped and the bottom scanline comes first.
+	float raster[3 * 2 * 3];
+	memcpy(raster, buf + sizeof header - 1, sizeof raster);
+	assert(float_equal(raster[3 * 3 + 0], 2.5f));
+	assert(float_equal(raster[3 * 3 + 1], -1.0f));
+	assert(float_equal(raster[3 * 3 + 2], 0.125f));
+	assert(float_equal(raster[3 * 2 + 2], 7.0f));
+
+	// A mapped canvas exports to exactly its own backing file.
+	char const* path = "test_export.pfm";
+	canvas* m = canvas_new_mapped(3, 2, "test_mapped.pfm");
+	assert(m != NULL);
+	m = write_pixel(m, 0, 0, &COLOUR(2.5f, -1.0f, 0.125f));
+	m = write_pixel(m, 2, 1, &COLOUR(0, 0, 7.0f));
+	assert(canvas_export_file(m, IMG_PFM, path) == path);
+	canvas_delete(&m);
+	remove("test_mapped.pfm");
+
+	__attribute__((cleanup(close_file)))FILE* fp = fopen(path, "rb");
+	assert(fp != NULL);
+	unsigned char got[128];
+	assert(fread(got, 1, sizeof got, fp) == size);
+	assert(memcmp(got, buf, size) == 0);
+	remove(path);
+
+	putchar('.');
+}
+
 void run_canvas_tests(void) {
 	test_canvas_creation();
 	test_canvas_write_pixel();
 	test_canvas_ppm_header_construction();
 	test_canvas_ppm_terminated_by_newline();
 	test_canvas_ppm_pixel_data_construction();
+	test_canvas_p6_header_construction();
+	test_canvas_p6_pixel_data_construction();
+	test_col3_quantize_matches_scalar();
+	test_canvas_export_mem_size_query();
+	test_canvas_export_mem_p3();
+	test_canvas_export_fd_matches_mem();
+	test_canvas_export_file_to_path();
+	test_canvas_mapped_writes_pfm_in_place();
+	test_canvas_wider_than_16_bits();
+	test_canvas_size_overflow();
+	test_canvas_stream_matches_export();
+	test_canvas_stream_qoi_run_across_bands();
+	test_canvas_stream_incomplete();
+	test_canvas_tiled_layout();
+	test_canvas_export_pfm();
 }
 
 #undef EPSILON
@@ -70,11 +70,42 @@ void test_colour_hadamard_multiplication(void) {
 	putchar('.');
 }
 
+static
+void test_colour_value_api(void) {
+	col3 c = COLOUR(0.9, 0.6, 0.75);
+	col3 d = COLOUR(0.7, 0.1, 0.25);
+
+	col3 out = col3_add(c, d);
+	assert(float_equal(out.red, 1.6));
+	assert(float_equal(out.green, 0.7));
+	assert(float_equal(out.blue, 1.0));
+
+	out = col3_sub(c, d);
+	assert(float_equal(out.red, 0.2));
+	assert(float_equal(out.green, 0.5));
+	assert(float_equal(out.blue, 0.5));
+
+	out = col3_scale(c, 2);
+	assert(float_equal(out.red, 1.8));
+	assert(float_equal(out.green, 1.2));
+	assert(float_equal(out.blue, 1.5));
+
+	out = col3_hadamard(COLOUR(1, 0.2, 0.4), COLOUR(0.9, 1, 0.1));
+	assert(float_equal(out.red, 0.9));
+	assert(float_equal(out.green, 0.2));
+	assert(float_equal(out.blue, 0.04));
+
+	static_assert(sizeof(col3) == 3 * sizeof(float), "col3 storage is unpadded");
+
+	putchar('.');
+}
+
 void run_col3_tests(void) {
 	test_colour_creation();
 	test_colour_addition();
 	test_colour_subtraction();
 	test_colour_scalar_multiplication();
 	test_colour_hadamard_multiplication();
+	test_colour_value_api();
 }
 
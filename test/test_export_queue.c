@@ -0,0 +1,114 @@
+#include "../src/headers/export_queue.h"
+
+#include "test_main.h"
+#include <string.h>
+#include <unistd.h>
+
+static
+void close_file(FILE** fp) {
+	if (*fp) {
+		fclose(*fp);
+	}
+}
+
+static
+bool file_matches(char const* path, canvas const* c, img_fmt fmt) {
+	unsigned char expected[1024], got[1024];
+	size_t size = canvas_export_mem(c, fmt, expected, sizeof expected);
+	__attribute__((cleanup(close_file)))FILE* fp = fopen(path, "rb");
+	return size && fp && fread(got, 1, sizeof got, fp) == size && memcmp(got, expected, size) == 0;
+}
+
+static
+void test_export_queue_double_buffered_frames(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* front = canvas_new(8, 6);
+	__attribute__((cleanup(canvas_delete)))canvas* back = canvas_new(8, 6);
+	export_queue* q = export_queue_new();
+	assert(q != NULL);
+
+	char const* paths[] = { "test_frame0.ppm", "test_frame1.ppm", "test_frame2.ppm" };
+	export_job jobs[2];
+	canvas* frames[2] = { front, back };
+
+	// Frame i renders into one canvas while frame i - 1 is being written
+	// from the other; a canvas is reused only once its job has finished.
+	for (unsigned i = 0; i < 3; i++) {
+		canvas* c = frames[i % 2];
+		if (i >= 2)
+			assert(export_wait(q, &jobs[i % 2]));
+		for (uint32_t y = 0; y < c->height; y++)
+			for (uint32_t x = 0; x < c->width; x++)
+				write_pixel(c, x, y, &COLOUR(i / 2.0f, x / 8.0f, y / 6.0f));
+		jobs[i % 2] = EXPORT_FILE(c, IMG_P6, paths[i]);
+		assert(export_queue_submit(q, &jobs[i % 2]));
+	}
+	assert(export_wait(q, &jobs[0]));
+	assert(export_wait(q, &jobs[1]));
+
+	assert(file_matches(paths[1], back, IMG_P6));
+	assert(file_matches(paths[2], front, IMG_P6));
+	for (unsigned i = 0; i < 3; i++)
+		remove(paths[i]);
+
+	export_queue_delete(&q);
+	assert(q == NULL);
+	putchar('.');
+}
+
+static
+void test_export_queue_reports_failures(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(4, 4);
+	export_queue* q = export_queue_new();
+	assert(q != NULL);
+
+	export_job bad = EXPORT_FILE(c, IMG_P6, "no/such/dir/frame.ppm");
+	assert(export_queue_submit(q, &bad));
+	assert(!export_wait(q, &bad));
+
+	int fds[2];
+	assert(pipe(fds) == 0);
+	export_job piped = EXPORT_FD(c, IMG_PFM, fds[1]);
+	assert(export_queue_submit(q, &piped));
+
+	// Deleting the queue finishes pending jobs first.
+	export_queue_delete(&q);
+	assert(piped.done && piped.ok);
+	close(fds[1]);
+
+	char header[4] = { };
+	assert(read(fds[0], header, 3) == 3);
+	assert(strcmp(header, "PF\n") == 0);
+	close(fds[0]);
+
+	assert(!export_queue_submit(nullptr, &bad));
+	putchar('.');
+}
+
+static
+void test_export_queue_wait_on_rejected_job(void) {
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(4, 4);
+	export_queue* q = export_queue_new();
+	assert(q != NULL);
+
+	export_job unsent = EXPORT_FILE(c, IMG_P6, "test_unsent.ppm");
+	assert(!export_wait(q, &unsent));
+
+	export_job blank = EXPORT_FD(nullptr, IMG_P6, 1);
+	assert(!export_queue_submit(q, &blank));
+	assert(!export_wait(q, &blank));
+
+	// A job left over from an earlier submission must not look pending.
+	export_job reused = EXPORT_FILE(c, IMG_P6, "test_unsent.ppm");
+	reused.done = false;
+	assert(!export_queue_submit(nullptr, &reused));
+	assert(!export_wait(q, &reused));
+
+	export_queue_delete(&q);
+	putchar('.');
+}
+
+void run_export_queue_tests(void) {
+	test_export_queue_double_buffered_frames();
+	test_export_queue_reports_failures();
+	test_export_queue_wait_on_rejected_job();
+}
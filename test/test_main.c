@@ -5,6 +5,14 @@ int main(void) {
 	run_col3_tests();
 	run_canvas_tests();
 	run_mat_tests();
+	run_qoi_tests();
+	run_export_queue_tests();
+	run_packet_tests();
+	run_tuple_array_tests();
+	run_transform_tests();
+	run_qtransform_tests();
+	run_scene_tests();
+	run_sphere_tests();
 	printf("\nAll tests run successfully.\n");
 	return 0;
 }
@@ -4,11 +4,23 @@
 #include <assert.h>
 #include <math.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
 void run_col3_tests(void);
 void run_vec3_tests(void);
 void run_canvas_tests(void);
 void run_mat_tests(void);
+void run_qoi_tests(void);
+void run_export_queue_tests(void);
+void run_packet_tests(void);
+void run_tuple_array_tests(void);
+void run_transform_tests(void);
+void run_qtransform_tests(void);
+void run_scene_tests(void);
+void run_sphere_tests(void);
+
+bool qoi_decode(uint8_t const* in, size_t len, uint32_t w, uint32_t h, uint8_t* out);
 
 #endif
@@ -546,6 +546,33 @@ void test_mat_invert_4x4_matrix_3(void) {
 	putchar('.');
 }
 
+static
+void test_mat_inverse_matches_cofactor_expansion(void) {
+	mat16 a = {
+		.m00= 2, .m01=-1, .m02= 0, .m03= 3,
+		.m10= 4, .m11= 1, .m12=-2, .m13= 0.5,
+		.m20=-3, .m21= 2, .m22= 5, .m23= 1,
+		.m30= 0, .m31= 6, .m32=-1, .m33= 2,
+	};
+
+	real det = 0;
+	for (unsigned c = 0; c < 4; c++)
+		det += a.data[c] * mat16_cofactor(&a, 0, c);
+	assert(float_equal(mat16_determinant(&a), det));
+
+	mat16 adj;
+	for (unsigned r = 0; r < 4; r++)
+		for (unsigned c = 0; c < 4; c++)
+			adj.data[c * 4 + r] = mat16_cofactor(&a, r, c) / det;
+	assert(mat16_is_equal(MAT16_INVERSE(&a), &adj));
+
+	// In place.
+	assert(mat16_inverse(&a, &a) == &a);
+	assert(mat16_is_equal(&a, &adj));
+
+	putchar('.');
+}
+
 static
 void test_mat_multiply_a_product_by_its_inverse(void) {
 	mat16 a = {
@@ -765,6 +792,233 @@ void test_mat_3D_rotation_about_z_axis(void) {
 	putchar('.');
 }
 
+static
+bool mat12_is_equal(mat12 const* a, mat12 const* b) {
+	for (unsigned i = 0; i < 12; i++)
+		if (!float_equal(a->data[i], b->data[i]))
+			return false;
+	return true;
+}
+
+static
+void test_mat12_conversions(void) {
+	mat16 a = ROTATION_Y(0.3);
+	a.m03 = 1;
+	a.m13 = -2;
+	a.m23 = 3.5;
+
+	mat12* m = MAT12_FROM_MAT16(&a);
+	assert(m);
+	assert(mat16_is_equal(MAT16_FROM_MAT12(m), &a));
+
+	mat16 projective = MAT16_IDENTITY;
+	projective.m32 = 1;
+	assert(MAT12_FROM_MAT16(&projective) == nullptr);
+	assert(mat12_from_mat16(nullptr, &(mat12){ }) == nullptr);
+	assert(mat16_from_mat12(&MAT12_IDENTITY, nullptr) == nullptr);
+
+	putchar('.');
+}
+
+static
+void test_mat12_matches_mat16(void) {
+	mat16 t = TRANSLATION(5, -3, 2);
+	mat16 s = SCALING(2, 3, 4);
+	mat16 r = ROTATION_X(RADIANS(30));
+	mat16 full = *MAT16_MUL(&t, MAT16_MUL(&r, &s));
+
+	mat12 at = *MAT12_FROM_MAT16(&t);
+	mat12 as = *MAT12_FROM_MAT16(&s);
+	mat12 ar = *MAT12_FROM_MAT16(&r);
+	mat12* affine = MAT12_MUL(&at, MAT12_MUL(&ar, &as));
+	assert(mat16_is_equal(MAT16_FROM_MAT12(affine), &full));
+
+	tuple inputs[] = { POINT(-3, 4, 5), VECTOR(-3, 4, 5), POINT(0, 0, 0) };
+	for (unsigned i = 0; i < 3; i++) {
+		tuple* expected = MAT16_MUL_TUPLE(&full, &inputs[i]);
+		tuple* got = MAT12_MUL_TUPLE(affine, &inputs[i]);
+		assert(float_equal(got->x, expected->x));
+		assert(float_equal(got->y, expected->y));
+		assert(float_equal(got->z, expected->z));
+		assert(float_equal(got->w, expected->w));
+	}
+
+	mat12* inv = MAT12_INVERSE(affine);
+	assert(inv);
+	assert(mat16_is_equal(MAT16_FROM_MAT12(inv), MAT16_INVERSE(&full)));
+	assert(mat12_is_equal(MAT12_MUL(affine, inv), &MAT12_IDENTITY));
+
+	// Composition and inversion in place.
+	mat12 m = *affine;
+	assert(mat12_inverse(&m, &m) == &m);
+	assert(mat12_is_equal(&m, inv));
+	assert(mat12_mul(&m, affine, &m) == &m);
+	assert(mat12_is_equal(&m, &MAT12_IDENTITY));
+
+	putchar('.');
+}
+
+static
+void test_mat12_singular(void) {
+	mat16 flat = SCALING(1, 0, 1);
+	assert(MAT12_INVERSE(MAT12_FROM_MAT16(&flat)) == nullptr);
+	assert(mat12_inverse(nullptr, &(mat12){ }) == nullptr);
+
+	putchar('.');
+}
+
+static
+void test_mat16_mul_tuple_array(void) {
+	mat16 a = {
+		.m00= 3, .m01=-9, .m02= 7, .m03= 3,
+		.m10= 3, .m11=-8, .m12= 2, .m13=-9,
+		.m20=-4, .m21= 4, .m22= 4, .m23= 1,
+		.m30=-6, .m31= 5, .m32=-1, .m33= 1,
+	};
+	tuple in[17];
+	tuple out[17];
+	for (unsigned i = 0; i < 17; i++)
+		in[i] = (tuple){ .x=i, .y=1.5 - i, .z=0.25 * i, .w=i & 1 };
+
+	assert(mat16_mul_tuple_array(&a, in, 17, out) == out);
+	for (unsigned i = 0; i < 17; i++) {
+		tuple* expected = MAT16_MUL_TUPLE(&a, &in[i]);
+		for (unsigned k = 0; k < 4; k++)
+			assert(float_equal(out[i].data[k], expected->data[k]));
+	}
+	assert(mat16_mul_tuple_array(nullptr, in, 17, out) == nullptr);
+
+	// Products written over an operand.
+	mat16 b = a;
+	mat16 expected = *MAT16_MUL(&a, &a);
+	assert(mat16_mul(&b, &b, &b) == &b);
+	assert(mat16_is_equal(&b, &expected));
+
+	putchar('.');
+}
+
+static
+void test_mat16_inverse_batch(void) {
+	enum { BATCHES = 3 };
+	mat16_soa a[BATCHES];
+	mat16_soa inv[BATCHES];
+	uint32_t status[BATCHES];
+	uint32_t expected[BATCHES] = { 0 };
+	size_t invertible = 0;
+
+	mat16 base = {
+		.m00= 9, .m01= 3, .m02= 0, .m03= 9,
+		.m10=-5, .m11=-2, .m12=-6, .m13=-3,
+		.m20=-4, .m21= 9, .m22= 6, .m23= 4,
+		.m30=-7, .m31= 6, .m32= 6, .m33= 2,
+	};
+	for (unsigned j = 0; j < BATCHES; j++)
+		for (unsigned i = 0; i < PACKET_WIDTH; i++) {
+			mat16 m = base;
+			m.m00 += j + i;
+			m.m12 -= 0.5 * i;
+			if ((i + j) % 3 == 2)
+				m = SCALING(1, i, 0);  // Singular.
+			else {
+				expected[j] |= 1u << i;
+				invertible++;
+			}
+			assert(mat16_soa_set(&a[j], i, &m) == &a[j]);
+		}
+	assert(mat16_soa_set(&a[0], PACKET_WIDTH, &base) == NULL);
+	assert(mat16_soa_set(&a[0], 0, NULL) == NULL);
+	assert(mat16_soa_get(&a[0], PACKET_WIDTH, &base) == NULL);
+	assert(mat16_soa_get(NULL, 0, &base) == NULL);
+
+	assert(mat16_inverse_batch(a, BATCHES, inv, status) == invertible);
+	for (unsigned j = 0; j < BATCHES; j++) {
+		assert(status[j] == expected[j]);
+		real_lanes det = mat16_soa_determinant(&a[j]);
+		for (unsigned i = 0; i < PACKET_WIDTH; i++) {
+			mat16 m, r;
+			mat16_soa_get(&a[j], i, &m);
+			mat16_soa_get(&inv[j], i, &r);
+			assert(float_equal(det[i], mat16_determinant(&m)));
+			if (status[j] >> i & 1)
+				assert(mat16_is_equal(&r, MAT16_INVERSE(&m)));
+			else
+				assert(mat16_is_equal(&r, &(mat16){ }));
+		}
+	}
+
+	// In place.
+	mat16_soa b = a[0];
+	assert(mat16_soa_inverse(&b, &b) == expected[0]);
+	for (unsigned k = 0; k < 16; k++)
+		for (unsigned i = 0; i < PACKET_WIDTH; i++)
+			assert(float_equal(b.data[k][i], inv[0].data[k][i]));
+
+	putchar('.');
+}
+
+static
+void test_sincos_deg_table(void) {
+	for (int d = -720; d <= 720; d += 7) {
+		sincos_pair sc = sincos_deg(d);
+		assert(float_equal(sc.s, sin(RADIANS((real)d))));
+		assert(float_equal(sc.c, cos(RADIANS((real)d))));
+	}
+	sincos_pair right = sincos_deg(-270);
+	assert(right.s == 1 && right.c == 0);
+
+	mat16 quarter = ROTATION_Z_DEG(90);
+	point3 p = POINT(0, 1, 0);
+	point3* out = MAT16_MUL_TUPLE(&quarter, &p);
+	assert(out->x == -1 && out->y == 0 && out->z == 0);
+
+	assert(mat16_is_equal(&ROTATION_X_DEG(30), &ROTATION_X(RADIANS(30))));
+	assert(mat16_is_equal(&ROTATION_Y_DEG(-135), &ROTATION_Y(RADIANS(-135))));
+
+	putchar('.');
+}
+
+static
+void test_rotation_axis_angle(void) {
+	real angles[] = { 0.3, -1.2, M_PI_2, 2.5 };
+	for (unsigned i = 0; i < 4; i++) {
+		real t = angles[i];
+		assert(mat16_is_equal(MAT16_ROTATION_AXIS(&VECTOR(2, 0, 0), t), &ROTATION_X(t)));
+		assert(mat16_is_equal(MAT16_ROTATION_AXIS(&VECTOR(0, 1, 0), t), &ROTATION_Y(t)));
+		assert(mat16_is_equal(MAT16_ROTATION_AXIS(&VECTOR(0, 0, 0.5), t), &ROTATION_Z(t)));
+	}
+
+	// Points on the axis stay put.
+	vec3 axis = VECTOR(1, 2, -2);
+	mat16* m = MAT16_ROTATION_AXIS(&axis, 0.7);
+	point3 p = POINT(3, 6, -6);
+	point3* out = MAT16_MUL_TUPLE(m, &p);
+	assert(float_equal(out->x, 3) && float_equal(out->y, 6) && float_equal(out->z, -6));
+
+	assert(MAT16_ROTATION_AXIS(&VECTOR(0, 0, 0), 1) == nullptr);
+	assert(rotation_axis_angle(nullptr, 1, &(mat16){ }) == nullptr);
+
+	putchar('.');
+}
+
+static
+void test_rotation_quat(void) {
+	vec3 axis = VECTOR(1, 2, -2);  // Length 3.
+	real t = 0.7;
+	real h = sin(t / 2) / 3;
+	quat q = QUAT(h * axis.x, h * axis.y, h * axis.z, cos(t / 2));
+
+	mat16* expected = MAT16_ROTATION_AXIS(&axis, t);
+	assert(mat16_is_equal(MAT16_FROM_QUAT(&q), expected));
+
+	quat scaled = tuple_scale(q, -4);
+	assert(mat16_is_equal(MAT16_FROM_QUAT(&scaled), expected));
+
+	assert(mat16_is_equal(MAT16_FROM_QUAT(&QUAT(0, 0, 0, 1)), &MAT16_IDENTITY));
+	assert(MAT16_FROM_QUAT(&QUAT(0, 0, 0, 0)) == nullptr);
+
+	putchar('.');
+}
+
 void run_mat_tests(void) {
 	test_mat_create_4x4_matrix();
 	test_mat_create_3x3_matrix();
@@ -800,6 +1054,15 @@ void run_mat_tests(void) {
 	test_mat_invert_4x4_matrix_2();
 	test_mat_invert_4x4_matrix_3();
 	test_mat_multiply_a_product_by_its_inverse();
+	test_mat_inverse_matches_cofactor_expansion();
+	test_mat12_conversions();
+	test_mat12_matches_mat16();
+	test_mat12_singular();
+	test_mat16_mul_tuple_array();
+	test_mat16_inverse_batch();
+	test_sincos_deg_table();
+	test_rotation_axis_angle();
+	test_rotation_quat();
 	putchar('\n');
 	test_mat_multiply_a_point_by_a_translation_matrix();
 	test_mat_multiply_a_point_by_inverse_of_a_translation_matrix();
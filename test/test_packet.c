@@ -0,0 +1,121 @@
+#include "../src/headers/packet.h"
+#include "test_main.h"
+
+#define EPSILON (sizeof(real) < sizeof(double) ? 1E-5 : 1E-9)
+
+static
+bool float_equal(real a, real b) {
+	return fabs(a - b) < EPSILON;
+}
+
+static
+bool tuple_equal(tuple a, tuple b) {
+	return float_equal(a.x, b.x) && float_equal(a.y, b.y)
+		&& float_equal(a.z, b.z) && float_equal(a.w, b.w);
+}
+
+/* Distinct, non-degenerate tuples for lane `i`. */
+static
+tuple lane_vector(unsigned i) {
+	return VECTOR(1 + i, 2 - 0.5 * i, 0.25 * i * i - 3);
+}
+
+static
+tuple lane_point(unsigned i) {
+	return POINT(-1.5 * i, 4 + i, 0.75 * i);
+}
+
+static
+void test_packet_ops_match_scalar(void) {
+	tuple_packet u, v;
+	for (unsigned i = 0; i < PACKET_WIDTH; i++) {
+		packet_set(&u, i, lane_point(i));
+		packet_set(&v, i, lane_vector(i));
+	}
+
+	tuple_packet sum = packet_add(u, v);
+	tuple_packet diff = packet_sub(u, v);
+	tuple_packet prod = packet_cross(v, packet_splat(VECTOR(0, 1, 2)));
+	tuple_packet unit = packet_unit(v);
+	real_lanes d = packet_dot(u, v);
+
+	for (unsigned i = 0; i < PACKET_WIDTH; i++) {
+		tuple p = lane_point(i);
+		tuple q = lane_vector(i);
+		assert(tuple_equal(packet_get(&sum, i), *VEC3_ADD(&p, &q)));
+		assert(tuple_equal(packet_get(&diff, i), *VEC3_SUB(&p, &q)));
+		assert(tuple_equal(packet_get(&prod, i), *VEC3_CROSS(&q, &VECTOR(0, 1, 2))));
+		assert(tuple_equal(packet_get(&unit, i), *VEC3_UNIT(&q)));
+		assert(float_equal(d[i], dot(&p, &q)));
+	}
+
+	putchar('.');
+}
+
+static
+void test_ray_packet_at(void) {
+	ray rays[PACKET_WIDTH];
+	real_lanes t;
+	for (unsigned i = 0; i < PACKET_WIDTH; i++) {
+		rays[i] = (ray){ .orig=lane_point(i), .dir=lane_vector(i) };
+		t[i] = 0.5 * i - 1;
+	}
+
+	ray_packet rp;
+	assert(ray_packet_load(rays, PACKET_WIDTH, &rp) == &rp);
+	assert(mask_bits(rp.active) == (uint32_t)((1ull << PACKET_WIDTH) - 1));
+
+	tuple_packet p = ray_packet_at(&rp, t);
+	for (unsigned i = 0; i < PACKET_WIDTH; i++)
+		assert(tuple_equal(packet_get(&p, i), *at(&rays[i], t[i], &(point3){ })));
+
+	putchar('.');
+}
+
+static
+void test_ray_packet_partial_load(void) {
+	ray rays[3] = {
+		{ .orig=POINT(0, 0, 0), .dir=VECTOR(1, 0, 0) },
+		{ .orig=POINT(1, 0, 0), .dir=VECTOR(0, 1, 0) },
+		{ .orig=POINT(2, 0, 0), .dir=VECTOR(0, 0, 1) },
+	};
+	ray_packet rp;
+
+	assert(ray_packet_load(nullptr, 3, &rp) == nullptr);
+	assert(ray_packet_load(rays, 3, nullptr) == nullptr);
+
+	ray_packet_load(rays, 3, &rp);
+	assert(mask_bits(rp.active) == 0b111);
+	assert(tuple_equal(packet_get(&rp.orig, 2), POINT(2, 0, 0)));
+	assert(tuple_equal(packet_get(&rp.dir, 3), (tuple){ }));
+
+	ray_packet_load(rays, 0, &rp);
+	assert(!mask_any(rp.active));
+
+	putchar('.');
+}
+
+static
+void test_lanes_select(void) {
+	real_lanes a = lanes_splat(1);
+	real_lanes b = lanes_splat(-1);
+	real_lanes t;
+	for (unsigned i = 0; i < PACKET_WIDTH; i++)
+		t[i] = i;
+
+	/* Keep `a` where t < 2, mirroring how a hit test narrows `active`. */
+	lane_mask hit = t < 2;
+	real_lanes r = lanes_select(hit, a, b);
+	assert(mask_bits(hit) == 0b11);
+	for (unsigned i = 0; i < PACKET_WIDTH; i++)
+		assert(float_equal(r[i], i < 2 ? 1 : -1));
+
+	putchar('.');
+}
+
+void run_packet_tests(void) {
+	test_packet_ops_match_scalar();
+	test_ray_packet_at();
+	test_ray_packet_partial_load();
+	test_lanes_select();
+}
@@ -0,0 +1,203 @@
+#include "../src/headers/canvas.h"
+#include "../src/headers/qoi.h"
+
+#include "test_main.h"
+#include <string.h>
+
+/**
+ * qoi_decode - straightforward sequential QOI decoder, following the format's
+ * reference implementation. Used to check that stripes and stream bands
+ * encoded on their own still decode as one image.
+ * @Returns: true if `in` is a well-formed w x h RGB image.
+ */
+bool qoi_decode(uint8_t const* in, size_t len, uint32_t w, uint32_t h, uint8_t* out) {
+	if (len < QOI_HEADER_SIZE + QOI_END_SIZE || memcmp(in, "qoif", 4) != 0)
+		return false;
+	uint32_t hw = (uint32_t)in[4] << 24 | in[5] << 16 | in[6] << 8 | in[7];
+	uint32_t hh = (uint32_t)in[8] << 24 | in[9] << 16 | in[10] << 8 | in[11];
+	if (hw != w || hh != h || in[12] != 3)
+		return false;
+
+	uint8_t index[64][4] = { };
+	uint8_t px[4] = { 0, 0, 0, 255 };
+	size_t p = QOI_HEADER_SIZE;
+	size_t end = len - QOI_END_SIZE;
+	unsigned run = 0;
+	for (size_t i = 0; i < (size_t)w * h; i++) {
+		if (run > 0) {
+			--run;
+		} else if (p < end) {
+			uint8_t b1 = in[p++];
+			if (b1 == 0xfe) {
+				px[0] = in[p++];
+				px[1] = in[p++];
+				px[2] = in[p++];
+			} else if ((b1 & 0xc0) == 0x00) {
+				memcpy(px, index[b1], 4);
+			} else if ((b1 & 0xc0) == 0x40) {
+				px[0] += ((b1 >> 4) & 0x03) - 2;
+				px[1] += ((b1 >> 2) & 0x03) - 2;
+				px[2] += (b1 & 0x03) - 2;
+			} else if ((b1 & 0xc0) == 0x80) {
+				uint8_t b2 = in[p++];
+				int vg = (b1 & 0x3f) - 32;
+				px[0] += vg - 8 + ((b2 >> 4) & 0x0f);
+				px[1] += vg;
+				px[2] += vg - 8 + (b2 & 0x0f);
+			} else {
+				run = b1 & 0x3f;
+			}
+			memcpy(index[(px[0] * 3 + px[1] * 5 + px[2] * 7 + px[3] * 11) % 64], px, 4);
+		} else {
+			return false;
+		}
+		memcpy(out + 3 * i, px, 3);
+	}
+	static uint8_t const marker[QOI_END_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+	return p == end && memcmp(in + end, marker, QOI_END_SIZE) == 0;
+}
+
+static
+void test_qoi_encode_chunks(void) {
+	uint8_t const rgb[] = {
+		0, 0, 0,        // run
+		0, 0, 0,        // run
+		1, 1, 1,        // diff
+		100, 50, 20,    // rgb
+		104, 60, 27,    // luma
+		1, 1, 1,        // index
+	};
+	uint8_t out[6 * QOI_PIXEL_MAX];
+	qoi_enc e;
+	qoi_enc_init(&e, nullptr);
+	size_t len = qoi_encode(&e, rgb, 6, out);
+	len += qoi_flush(&e, out + len);
+
+	uint8_t const expected[] = {
+		0xc0 | 1,
+		0x40 | 3 << 4 | 3 << 2 | 3,
+		0xfe, 100, 50, 20,
+		0x80 | (10 + 32), (4 - 10 + 8) << 4 | (7 - 10 + 8),
+		0x00 | (1 * 3 + 1 * 5 + 1 * 7 + 255 * 11) % 64,
+	};
+	assert(len == sizeof expected);
+	assert(memcmp(out, expected, len) == 0);
+
+	putchar('.');
+}
+
+static
+void test_qoi_seeded_encoder_never_indexes_unseen_colours(void) {
+	// Seeded with (1, 1, 1), the encoder may only index that colour.
+	uint8_t const prev[3] = { 1, 1, 1 };
+	uint8_t const rgb[] = { 1, 1, 1, 200, 0, 0, 1, 1, 1 };
+	uint8_t out[3 * QOI_PIXEL_MAX];
+	qoi_enc e;
+	qoi_enc_init(&e, prev);
+	size_t len = qoi_encode(&e, rgb, 3, out);
+	len += qoi_flush(&e, out + len);
+
+	assert(len == 1 + 4 + 1);
+	assert(out[0] == (0xc0 | 0));
+	assert(out[1] == 0xfe);
+	assert(out[5] == (1 * 3 + 1 * 5 + 1 * 7 + 255 * 11) % 64);
+
+	putchar('.');
+}
+
+static
+void fill(canvas* c) {
+	for (uint32_t y = 0; y < c->height; y++)
+		for (uint32_t x = 0; x < c->width; x++) {
+			// Flat areas, smooth gradients and noise hit every chunk type.
+			float noise = (float)((x * 7919u + y * 104729u) % 256) / 255;
+			col3 colour = y % 50 < 10 ? COLOUR(0.2f, 0.4f, 0.6f)
+				: y % 50 < 30 ? COLOUR(x / (float)c->width, y / (float)c->height, 0.5f)
+				: COLOUR(noise, 1 - noise, noise / 2);
+			write_pixel(c, x, y, &colour);
+		}
+}
+
+static
+void test_qoi_export_round_trip(void) {
+	// 256 pixels wide makes stripes of 256 scanlines: three of them.
+	uint32_t const w = 256, h = 600;
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(w, h);
+	fill(c);
+
+	size_t raw_size = canvas_export_size(c, IMG_P6);
+	uint8_t* raw = malloc(raw_size);
+	assert(canvas_export_mem(c, IMG_P6, raw, raw_size) == raw_size);
+	uint8_t const* pixels = raw + raw_size - 3 * (size_t)w * h;
+
+	size_t bound = canvas_export_size(c, IMG_QOI);
+	uint8_t* qoi = malloc(bound);
+	size_t len = canvas_export_mem(c, IMG_QOI, qoi, bound);
+	assert(len > 0 && len < raw_size);
+	assert(canvas_export_mem(c, IMG_QOI, qoi, len - 1) == 0);
+
+	uint8_t* decoded = malloc(3 * (size_t)w * h);
+	assert(qoi_decode(qoi, len, w, h, decoded));
+	assert(memcmp(decoded, pixels, 3 * (size_t)w * h) == 0);
+
+	// The file sink produces the same bytes.
+	char const* path = "test_export.qoi";
+	assert(canvas_export_file(c, IMG_QOI, path) == path);
+	FILE* fp = fopen(path, "rb");
+	assert(fp != NULL);
+	uint8_t* file = malloc(len + 1);
+	assert(fread(file, 1, len + 1, fp) == len);
+	assert(memcmp(file, qoi, len) == 0);
+	fclose(fp);
+	remove(path);
+
+	free(file);
+	free(decoded);
+	free(qoi);
+	free(raw);
+	putchar('.');
+}
+
+static
+void test_qoi_stream_round_trip(void) {
+	uint32_t const w = 40, h = 30;
+	__attribute__((cleanup(canvas_delete)))canvas* c = canvas_new(w, h);
+	fill(c);
+
+	char const* path = "test_stream.qoi";
+	canvas_stream* s = canvas_stream_open_file(w, h, 7, IMG_QOI, path);
+	assert(s != NULL);
+	canvas* band;
+	uint32_t y0;
+	while ((band = canvas_stream_band(s, &y0))) {
+		for (uint32_t y = 0; y < band->height; y++)
+			for (uint32_t x = 0; x < w; x++)
+				write_pixel(band, x, y, (col3*)pixel_at(c, x, y0 + y));
+		assert(canvas_stream_commit(s));
+	}
+	assert(canvas_stream_close(&s));
+
+	uint8_t raw[64 + 3 * 40 * 30];
+	size_t raw_size = canvas_export_mem(c, IMG_P6, raw, sizeof raw);
+	assert(raw_size > 0);
+
+	uint8_t qoi[QOI_HEADER_SIZE + QOI_PIXEL_MAX * 40 * 30 + QOI_END_SIZE];
+	FILE* fp = fopen(path, "rb");
+	assert(fp != NULL);
+	size_t len = fread(qoi, 1, sizeof qoi, fp);
+	fclose(fp);
+	remove(path);
+
+	uint8_t decoded[3 * 40 * 30];
+	assert(qoi_decode(qoi, len, w, h, decoded));
+	assert(memcmp(decoded, raw + raw_size - sizeof decoded, sizeof decoded) == 0);
+
+	putchar('.');
+}
+
+void run_qoi_tests(void) {
+	test_qoi_encode_chunks();
+	test_qoi_seeded_encoder_never_indexes_unseen_colours();
+	test_qoi_export_round_trip();
+	test_qoi_stream_round_trip();
+}
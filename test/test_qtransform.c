@@ -0,0 +1,89 @@
+#include "../src/headers/qtransform.h"
+#include "test_main.h"
+
+#define EPSILON 1E-5
+
+static
+bool float_equal(real a, real b) {
+	return fabs(a - b) < EPSILON;
+}
+
+static
+bool tuple_equal(tuple const* a, tuple const* b) {
+	return float_equal(a->x, b->x) && float_equal(a->y, b->y)
+		&& float_equal(a->z, b->z) && float_equal(a->w, b->w);
+}
+
+static
+mat16 sample(real angle, real s, real tx) {
+	mat16 r = *MAT16_ROTATION_AXIS(&VECTOR(1, 2, -2), angle);
+	return *MAT16_MUL(&TRANSLATION(tx, -1, 2), MAT16_MUL(&SCALING(s, s, s), &r));
+}
+
+static
+void test_qtransform_round_trip(void) {
+	static_assert(sizeof(qtransform) * 2 == sizeof(mat16), "half a mat16");
+
+	real angles[] = { 0, 0.4, 2.0, 3.1, -2.9 };
+	for (unsigned i = 0; i < 5; i++) {
+		mat16 m = sample(angles[i], 1.5 + i, i);
+		qtransform* q = QTRANSFORM_FROM_MAT16(&m);
+		assert(q);
+		assert(float_equal(q->scale, 1.5 + i));
+		assert(float_equal(tuple_len(q->rotation), 1));
+		assert(mat16_is_equal(MAT16_FROM_QTRANSFORM(q), &m));
+	}
+
+	mat16 x = ROTATION_X(M_PI);
+	assert(mat16_is_equal(MAT16_FROM_QTRANSFORM(QTRANSFORM_FROM_MAT16(&x)), &x));
+
+	putchar('.');
+}
+
+static
+void test_qtransform_rejects_non_similarity(void) {
+	assert(QTRANSFORM_FROM_MAT16(&SCALING(1, 2, 1)) == nullptr);
+	assert(QTRANSFORM_FROM_MAT16(&SCALING(-1, -1, -1)) == nullptr);
+	mat16 shear = MAT16_IDENTITY;
+	shear.m01 = 0.5;
+	assert(QTRANSFORM_FROM_MAT16(&shear) == nullptr);
+	mat16 projective = MAT16_IDENTITY;
+	projective.m31 = 1;
+	assert(QTRANSFORM_FROM_MAT16(&projective) == nullptr);
+
+	putchar('.');
+}
+
+static
+void test_qtransform_apply_compose_inverse(void) {
+	mat16 a = sample(0.9, 2, 3);
+	mat16 b = sample(-2.2, 0.5, -1);
+	qtransform qa = *QTRANSFORM_FROM_MAT16(&a);
+	qtransform qb = *QTRANSFORM_FROM_MAT16(&b);
+
+	tuple inputs[] = { POINT(1, -2, 3), VECTOR(1, -2, 3) };
+	for (unsigned i = 0; i < 2; i++)
+		assert(tuple_equal(QTRANSFORM_TUPLE(&qa, &inputs[i]), MAT16_MUL_TUPLE(&a, &inputs[i])));
+
+	qtransform* ab = QTRANSFORM_COMPOSE(&qa, &qb);
+	assert(mat16_is_equal(MAT16_FROM_QTRANSFORM(ab), MAT16_MUL(&a, &b)));
+
+	qtransform* inv = QTRANSFORM_INVERSE(&qa);
+	assert(mat16_is_equal(MAT16_FROM_QTRANSFORM(inv), MAT16_INVERSE(&a)));
+	assert(mat16_is_equal(MAT16_FROM_QTRANSFORM(QTRANSFORM_COMPOSE(inv, &qa)), &MAT16_IDENTITY));
+
+	// In place.
+	assert(qtransform_compose(&qa, &qb, &qa) == &qa);
+	assert(mat16_is_equal(MAT16_FROM_QTRANSFORM(&qa), MAT16_MUL(&a, &b)));
+
+	assert(qtransform_tuple(nullptr, &inputs[0], &(tuple){ }) == nullptr);
+	assert(qtransform_inverse(&qb, nullptr) == nullptr);
+
+	putchar('.');
+}
+
+void run_qtransform_tests(void) {
+	test_qtransform_round_trip();
+	test_qtransform_rejects_non_similarity();
+	test_qtransform_apply_compose_inverse();
+}
@@ -0,0 +1,93 @@
+#include "../src/headers/scene.h"
+#include "test_main.h"
+
+#define EPSILON 1E-5
+
+static
+bool float_equal(real a, real b) {
+	return fabs(a - b) < EPSILON;
+}
+
+static
+bool tuple_equal(tuple const* a, tuple const* b) {
+	return float_equal(a->x, b->x) && float_equal(a->y, b->y)
+		&& float_equal(a->z, b->z) && float_equal(a->w, b->w);
+}
+
+static
+void test_scene_world_transforms(void) {
+	scene_node root, arm, hand;
+	assert(scene_node_init(&root, &TRANSLATION(10, 0, 0)) == &root);
+	scene_node_init(&arm, &ROTATION_Z(M_PI_2));
+	scene_node_init(&hand, &TRANSLATION(0, 1, 0));
+	assert(scene_node_attach(&root, &arm) == &arm);
+	scene_node_attach(&arm, &hand);
+
+	transform const* w = scene_node_world(&hand);
+	point3 origin = POINT(0, 0, 0);
+	assert(tuple_equal(TRANSFORM_TUPLE(w, &origin), &POINT(9, 0, 0)));
+
+	mat16 expected = *MAT16_MUL(&root.local.forward, MAT16_MUL(&arm.local.forward, &hand.local.forward));
+	assert(mat16_is_equal(&w->forward, &expected));
+	assert(mat16_is_equal(&w->inverse, MAT16_INVERSE(&expected)));
+	mat16 it = *MAT16_INVERSE(&expected);
+	assert(mat16_is_equal(&w->inverse_transpose, mat16_transpose(&it)));
+
+	putchar('.');
+}
+
+static
+void test_scene_dirty_propagation(void) {
+	scene_node root, a, b, leaf;
+	scene_node_init(&root, &MAT16_IDENTITY);
+	scene_node_init(&a, &TRANSLATION(1, 0, 0));
+	scene_node_init(&b, &TRANSLATION(0, 1, 0));
+	scene_node_init(&leaf, &SCALING(2, 2, 2));
+	scene_node_attach(&root, &a);
+	scene_node_attach(&root, &b);
+	scene_node_attach(&a, &leaf);
+
+	assert(scene_update(&root) == 4);
+	assert(scene_update(&root) == 0);
+
+	// Moving `a` touches `a` and `leaf` only.
+	scene_node_set_local(&a, &TRANSLATION(5, 0, 0));
+	assert(!root.dirty && a.dirty && !b.dirty && leaf.dirty);
+	assert(scene_update(&root) == 2);
+
+	point3 p = POINT(1, 1, 1);
+	assert(tuple_equal(TRANSFORM_TUPLE(scene_node_world(&leaf), &p), &POINT(7, 2, 2)));
+
+	// Reparenting `leaf` under `b`.
+	scene_node_attach(&b, &leaf);
+	assert(a.first_child == nullptr && b.first_child == &leaf);
+	assert(scene_update(&root) == 1);
+	assert(tuple_equal(TRANSFORM_TUPLE(scene_node_world(&leaf), &p), &POINT(2, 3, 2)));
+
+	scene_node_detach(&leaf);
+	assert(leaf.parent == nullptr && b.first_child == nullptr);
+	assert(mat16_is_equal(&scene_node_world(&leaf)->forward, &SCALING(2, 2, 2)));
+
+	putchar('.');
+}
+
+static
+void test_scene_null(void) {
+	scene_node n;
+	scene_node_init(&n, &MAT16_IDENTITY);
+
+	assert(scene_node_init(nullptr, &MAT16_IDENTITY) == nullptr);
+	assert(scene_node_set_local(&n, nullptr) == nullptr);
+	assert(scene_node_attach(&n, &n) == nullptr);
+	assert(scene_node_detach(nullptr) == nullptr);
+	assert(scene_node_world(nullptr) == nullptr);
+	assert(scene_update(nullptr) == 0);
+
+	putchar('.');
+}
+
+void run_scene_tests(void) {
+	test_scene_world_transforms();
+	test_scene_dirty_propagation();
+	test_scene_null();
+}
@@ -0,0 +1,116 @@
+#include "../src/headers/sphere.h"
+#include "test_main.h"
+
+// Near-tangent hits lose about half of a float mantissa to cancellation.
+#define EPSILON (sizeof(real) < sizeof(double) ? 1E-3 : 1E-5)
+
+static
+bool float_equal(real a, real b) {
+	return fabs(a - b) < EPSILON;
+}
+
+/* Scalar reference: intersections of `r` with the sphere (c, radius). */
+static
+bool reference_hit(ray const* r, point3 c, real radius, real* t0, real* t1) {
+	vec3 oc = tuple_sub(r->orig, c);
+	real a = tuple_dot(r->dir, r->dir);
+	real h = tuple_dot(r->dir, oc);
+	real disc = h * h - a * (tuple_dot(oc, oc) - radius * radius);
+	if (disc < 0)
+		return false;
+	*t0 = (-h - sqrt(disc)) / a;
+	*t1 = (-h + sqrt(disc)) / a;
+	return true;
+}
+
+static
+void test_sphere_batch_intersect(void) {
+	static_assert(PACKET_WIDTH >= 4, "four spheres below");
+	sphere_batch b = SPHERE_BATCH_EMPTY;
+	assert(sphere_batch_set(&b, 0, &POINT(0, 0, 0), 1) == &b);  // Through the centre.
+	sphere_batch_set(&b, 1, &POINT(0, 1, 0), 1);                // Tangent.
+	sphere_batch_set(&b, 2, &POINT(0, 3, 0), 1);                // Miss.
+	sphere_batch_set(&b, 3, &POINT(0, 0, 0), 2);                // Scaled.
+	ray r = { .orig=POINT(0, 0, -5), .dir=VECTOR(0, 0, 1) };
+
+	real_lanes t0, t1;
+	lane_mask hit = sphere_batch_intersect(&b, &r, &t0, &t1);
+	assert(mask_bits(hit) == 0b1011);
+	assert(float_equal(t0[0], 4) && float_equal(t1[0], 6));
+	assert(float_equal(t0[1], 5) && float_equal(t1[1], 5));
+	assert(isinf(t0[2]) && isinf(t1[2]));
+	assert(float_equal(t0[3], 3) && float_equal(t1[3], 7));
+
+	// From inside and from behind.
+	r.orig = POINT(0, 0, 0);
+	sphere_batch_intersect(&b, &r, &t0, &t1);
+	assert(float_equal(t0[0], -1) && float_equal(t1[0], 1));
+	r.orig = POINT(0, 0, 5);
+	sphere_batch_intersect(&b, &r, &t0, &t1);
+	assert(float_equal(t0[0], -6) && float_equal(t1[0], -4));
+
+	// A general affine sphere: scaled, rotated and translated.
+	mat16 m = *MAT16_MUL(&TRANSLATION(1, 2, 3), MAT16_MUL(&ROTATION_Y(0.5), &SCALING(2, 2, 2)));
+	assert(sphere_batch_set_transform(&b, 2, MAT12_FROM_MAT16(&m)) == &b);
+	r = (ray){ .orig=POINT(1, 2, -10), .dir=VECTOR(0, 0, 2) };
+	hit = sphere_batch_intersect(&b, &r, &t0, &t1);
+	assert(mask_bits(hit) & 0b100);
+	assert(float_equal(t0[2], 5.5) && float_equal(t1[2], 7.5));
+
+	assert(sphere_batch_set(&b, 0, &POINT(0, 0, 0), 0) == nullptr);
+	uint32_t active = mask_bits(b.active);
+	assert(sphere_batch_set(&b, PACKET_WIDTH, &POINT(0, 0, 0), 1) == nullptr);
+	assert(sphere_batch_set_transform(&b, PACKET_WIDTH, MAT12_FROM_MAT16(&m)) == nullptr);
+	assert(mask_bits(b.active) == active);
+	assert(!mask_any(sphere_batch_intersect(nullptr, &r, &t0, &t1)));
+
+	putchar('.');
+}
+
+static
+void test_spheres_closest_hit(void) {
+	enum { BATCHES = 5, COUNT = BATCHES * PACKET_WIDTH - 3 };
+	sphere_batch b[BATCHES];
+	point3 centres[COUNT];
+	real radii[COUNT];
+	for (unsigned j = 0; j < BATCHES; j++)
+		b[j] = SPHERE_BATCH_EMPTY;
+	for (unsigned k = 0; k < COUNT; k++) {
+		centres[k] = POINT((real)(k % 7) - 3, (real)(k % 5) - 2, (real)(k % 11) * 2);
+		radii[k] = 0.3 + 0.1 * (k % 4);
+		sphere_batch_set(&b[k / PACKET_WIDTH], k % PACKET_WIDTH, &centres[k], radii[k]);
+	}
+
+	for (int y = -3; y <= 3; y++)
+		for (int x = -4; x <= 4; x++) {
+			ray r = { .orig=POINT(0, 0, -5), .dir=VECTOR(0.1 * x, 0.1 * y, 1) };
+			real expected = INFINITY;
+			size_t expected_index = COUNT;
+			for (unsigned k = 0; k < COUNT; k++) {
+				real t0, t1;
+				if (!reference_hit(&r, centres[k], radii[k], &t0, &t1))
+					continue;
+				real t = t0 > 0 ? t0 : t1 > 0 ? t1 : INFINITY;
+				if (t < expected) {
+					expected = t;
+					expected_index = k;
+				}
+			}
+
+			size_t index = COUNT;
+			real t = spheres_closest_hit(b, BATCHES, &r, &index);
+			if (isinf(expected)) {
+				assert(isinf(t) && index == COUNT);
+			} else {
+				assert(float_equal(t, expected));
+				assert(index == expected_index);
+			}
+		}
+
+	putchar('.');
+}
+
+void run_sphere_tests(void) {
+	test_sphere_batch_intersect();
+	test_spheres_closest_hit();
+}
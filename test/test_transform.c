@@ -0,0 +1,106 @@
+#include "../src/headers/transform.h"
+#include "test_main.h"
+
+#define EPSILON 1E-5
+
+static
+bool float_equal(real a, real b) {
+	return fabs(a - b) < EPSILON;
+}
+
+static
+bool tuple_equal(tuple const* a, tuple const* b) {
+	return float_equal(a->x, b->x) && float_equal(a->y, b->y)
+		&& float_equal(a->z, b->z) && float_equal(a->w, b->w);
+}
+
+static
+void test_transform_caches_inverse(void) {
+	mat16 m = *MAT16_MUL(&TRANSLATION(1, 2, 3), &SCALING(2, 4, 8));
+	transform t = TRANSFORM_IDENTITY;
+
+	assert(transform_set(&t, &m) == &t);
+	assert(mat16_is_equal(&t.forward, &m));
+	assert(mat16_is_equal(&t.inverse, MAT16_INVERSE(&m)));
+	mat16 it = *MAT16_INVERSE(&m);
+	assert(mat16_is_equal(&t.inverse_transpose, mat16_transpose(&it)));
+
+	point3 p = POINT(1, 1, 1);
+	assert(tuple_equal(TRANSFORM_TUPLE(&t, &p), &POINT(3, 6, 11)));
+
+	putchar('.');
+}
+
+static
+void test_transform_compose(void) {
+	transform t = TRANSFORM_IDENTITY;
+	transform_set(&t, &ROTATION_X(M_PI_2));
+	assert(transform_compose(&t, &SCALING(5, 5, 5)) == &t);
+	assert(transform_compose(&t, &TRANSLATION(10, 5, 7)) == &t);
+
+	point3 p = POINT(1, 0, 1);
+	assert(tuple_equal(TRANSFORM_TUPLE(&t, &p), &POINT(15, 0, 7)));
+	assert(mat16_is_equal(MAT16_MUL(&t.forward, &t.inverse), &MAT16_IDENTITY));
+
+	putchar('.');
+}
+
+static
+void test_transform_normal(void) {
+	transform t = TRANSFORM_IDENTITY;
+	transform_set(&t, &SCALING(1, 0.5, 1));
+
+	real h = sqrt(2) / 2;
+	vec3 n = VECTOR(0, h, -h);
+	vec3* out = TRANSFORM_NORMAL(&t, &n);
+	assert(tuple_equal(out, &VECTOR(0, 2 / sqrt(5), -1 / sqrt(5))));
+
+	// Normals stay perpendicular to transformed tangents.
+	mat16 m = *MAT16_MUL(&SCALING(1, 0.5, 1), &ROTATION_Z(M_PI / 5));
+	transform_set(&t, &m);
+	vec3 tangent = VECTOR(3, h, h);
+	out = TRANSFORM_NORMAL(&t, &n);
+	assert(float_equal(dot(out, TRANSFORM_TUPLE(&t, &tangent)), 0));
+	assert(float_equal(len(out), 1));
+
+	// Translation does not move normals.
+	transform_set(&t, &TRANSLATION(0, 1, 0));
+	out = TRANSFORM_NORMAL(&t, &n);
+	assert(tuple_equal(out, &n));
+
+	putchar('.');
+}
+
+static
+void test_transform_ray_to_object(void) {
+	transform t = TRANSFORM_IDENTITY;
+	transform_set(&t, &SCALING(2, 2, 2));
+	ray r = { .orig=POINT(0, 0, -5), .dir=VECTOR(0, 0, 1) };
+
+	ray* local = TRANSFORM_RAY_TO_OBJECT(&t, &r);
+	assert(tuple_equal(&local->orig, &POINT(0, 0, -2.5)));
+	assert(tuple_equal(&local->dir, &VECTOR(0, 0, 0.5)));
+
+	putchar('.');
+}
+
+static
+void test_transform_rejects_singular(void) {
+	transform t = TRANSFORM_IDENTITY;
+	transform_set(&t, &TRANSLATION(1, 0, 0));
+
+	assert(transform_set(&t, &SCALING(0, 1, 1)) == nullptr);
+	assert(mat16_is_equal(&t.forward, &TRANSLATION(1, 0, 0)));
+	assert(transform_set(nullptr, &MAT16_IDENTITY) == nullptr);
+	assert(transform_compose(&t, nullptr) == nullptr);
+
+	putchar('.');
+}
+
+void run_transform_tests(void) {
+	test_transform_caches_inverse();
+	test_transform_compose();
+	test_transform_normal();
+	test_transform_ray_to_object();
+	test_transform_rejects_singular();
+}
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+
+#include "../src/headers/tuple_array.h"
+#include "test_main.h"
+
+#define EPSILON (sizeof(real) < sizeof(double) ? 1E-5 : 1E-9)
+#define N 1000
+
+static
+bool float_equal(real a, real b) {
+	return fabs(a - b) < EPSILON;
+}
+
+static
+bool tuple_equal(tuple const* a, tuple const* b) {
+	return float_equal(a->x, b->x) && float_equal(a->y, b->y)
+		&& float_equal(a->z, b->z) && float_equal(a->w, b->w);
+}
+
+static
+void fill(tuple* a, tuple* b, size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		a[i] = VECTOR(1 + i % 7, 0.5 * (i % 5), -(real)(i % 3) - 1);
+		b[i] = POINT(0.25 * (i % 11), 2 - (real)(i % 13), 3);
+	}
+}
+
+static
+void test_tuple_array_match_scalar(void) {
+	tuple* a = aligned_alloc(alignof(tuple), N * sizeof *a);
+	tuple* b = aligned_alloc(alignof(tuple), N * sizeof *b);
+	tuple* out = aligned_alloc(alignof(tuple), N * sizeof *out);
+	real* dots = malloc(N * sizeof *dots);
+	assert(a && b && out && dots);
+	fill(a, b, N);
+
+	assert(tuple_array_add(a, b, N, out) == out);
+	for (size_t i = 0; i < N; i++)
+		assert(tuple_equal(&out[i], VEC3_ADD(&a[i], &b[i])));
+
+	assert(tuple_array_offset(a, VECTOR(1, -2, 3), N, out) == out);
+	for (size_t i = 0; i < N; i++)
+		assert(tuple_equal(&out[i], VEC3_ADD(&a[i], &VECTOR(1, -2, 3))));
+
+	assert(tuple_array_scale(a, -2.5, N, out) == out);
+	for (size_t i = 0; i < N; i++)
+		assert(tuple_equal(&out[i], VEC3_MUL(&a[i], -2.5)));
+
+	assert(tuple_array_normalize(a, N, out) == out);
+	for (size_t i = 0; i < N; i++)
+		assert(tuple_equal(&out[i], VEC3_UNIT(&a[i])));
+
+	assert(tuple_array_normalize_fast(a, N, out) == out);
+	for (size_t i = 0; i < N; i++) {
+		tuple fast = tuple_unit_fast(a[i]);
+		assert(tuple_equal(&out[i], &fast));
+	}
+
+	assert(tuple_array_cross(a, b, N, out) == out);
+	for (size_t i = 0; i < N; i++)
+		assert(tuple_equal(&out[i], VEC3_CROSS(&a[i], &b[i])));
+
+	assert(tuple_array_dot(a, b, N, dots) == dots);
+	for (size_t i = 0; i < N; i++)
+		assert(float_equal(dots[i], dot(&a[i], &b[i])));
+
+	free(dots);
+	free(out);
+	free(b);
+	free(a);
+	putchar('.');
+}
+
+static
+void test_tuple_array_inplace(void) {
+	tuple* a = aligned_alloc(alignof(tuple), N * sizeof *a);
+	tuple* b = aligned_alloc(alignof(tuple), N * sizeof *b);
+	tuple* ref = aligned_alloc(alignof(tuple), N * sizeof *ref);
+	assert(a && b && ref);
+	fill(a, b, N);
+
+	for (size_t i = 0; i < N; i++)
+		ref[i] = tuple_unit(tuple_scale(tuple_cross(tuple_add(tuple_add(a[i], b[i]), VECTOR(0, 0, 1)), b[i]), 3));
+
+	assert(tuple_array_add_inplace(a, b, N) == a);
+	assert(tuple_array_offset_inplace(a, VECTOR(0, 0, 1), N) == a);
+	assert(tuple_array_cross_inplace(a, b, N) == a);
+	assert(tuple_array_scale_inplace(a, 3, N) == a);
+	assert(tuple_array_normalize_inplace(a, N) == a);
+	for (size_t i = 0; i < N; i++)
+		assert(tuple_equal(&a[i], &ref[i]));
+
+	free(ref);
+	free(b);
+	free(a);
+	putchar('.');
+}
+
+static
+void test_tuple_array_null(void) {
+	tuple t[1] = { VECTOR(1, 2, 3) };
+	tuple out;
+
+	assert(tuple_array_add(nullptr, t, 1, &out) == nullptr);
+	assert(tuple_array_add_inplace(t, nullptr, 1) == nullptr);
+	assert(tuple_array_offset(t, VECTOR(1, 1, 1), 1, nullptr) == nullptr);
+	assert(tuple_array_scale_inplace(nullptr, 2, 1) == nullptr);
+	assert(tuple_array_normalize(nullptr, 1, &out) == nullptr);
+	assert(tuple_array_dot(t, t, 1, nullptr) == nullptr);
+	assert(tuple_array_cross(t, nullptr, 1, &out) == nullptr);
+	assert(tuple_array_cross_inplace(nullptr, t, 1) == nullptr);
+	assert(tuple_array_scale(t, 2, 0, &out) == &out);
+
+	putchar('.');
+}
+
+void run_tuple_array_tests(void) {
+	test_tuple_array_match_scalar();
+	test_tuple_array_inplace();
+	test_tuple_array_null();
+}
@@ -1,10 +1,11 @@
 #include "../src/headers/vec3.h"
 #include "test_main.h"
 
-#define EPSILON 1E-9
+// Single precision builds (RT_REAL=float) hold about seven digits.
+#define EPSILON (sizeof(real) < sizeof(double) ? 1E-5 : 1E-9)
 
 static
-bool float_equal(double a, double b) {
+bool float_equal(real a, real b) {
 	return fabs(a - b) < EPSILON;
 }
 
@@ -315,6 +316,82 @@ void test_magnitude_of_unit_vector(void) {
 	putchar('.');
 }
 
+static
+bool tuple_equal(tuple const* a, tuple const* b) {
+	return float_equal(a->x, b->x) && float_equal(a->y, b->y)
+		&& float_equal(a->z, b->z) && float_equal(a->w, b->w);
+}
+
+static
+void test_value_api_matches_pointer_api(void) {
+	point3 p = POINT(3, -2, 5);
+	vec3 u = VECTOR(1, 2, 3);
+	vec3 v = VECTOR(-2, 3, 4);
+
+	tuple r = tuple_add(p, v);
+	assert(tuple_equal(&r, VEC3_ADD(&p, &v)));
+	r = tuple_sub(p, v);
+	assert(tuple_equal(&r, VEC3_SUB(&p, &v)));
+	r = tuple_negate(p);
+	assert(tuple_equal(&r, VEC3_NEGATE(&p)));
+	r = tuple_scale(u, 3.5);
+	assert(tuple_equal(&r, VEC3_MUL(&u, 3.5)));
+	r = tuple_div(u, 2);
+	assert(tuple_equal(&r, VEC3_DIV(&u, 2)));
+	r = tuple_cross(u, v);
+	assert(tuple_equal(&r, VEC3_CROSS(&u, &v)));
+	r = tuple_unit(u);
+	assert(tuple_equal(&r, VEC3_UNIT(&u)));
+
+	assert(float_equal(tuple_dot(u, v), dot(&u, &v)));
+	assert(float_equal(tuple_len_squared(u), len_squared(&u)));
+	assert(float_equal(tuple_len(u), len(&u)));
+
+	static_assert(alignof(tuple) == 4 * sizeof(real), "tuple is one vector register");
+	r = tuple_cross(VECTOR(1, 0, 0), VECTOR(0, 1, 0));
+	assert(tuple_equal(&r, &VECTOR(0, 0, 1)));
+
+	putchar('.');
+}
+
+static
+void test_value_api_chains(void) {
+	point3 p = POINT(0, 1, 0);
+	vec3 v = VECTOR(1, 1.8, 0);
+	vec3 g = VECTOR(0, -0.1, 0);
+	vec3 w = VECTOR(-0.01, 0, 0);
+
+	p = tuple_add(p, v);
+	v = tuple_add(tuple_add(v, g), w);
+
+	assert(tuple_equal(&p, &POINT(1, 2.8, 0)));
+	assert(tuple_equal(&v, &VECTOR(0.99, 1.7, 0)));
+	assert(float_equal(tuple_len(tuple_unit(tuple_cross(v, g))), 1.0));
+
+	putchar('.');
+}
+
+static
+void test_unit_fast_accuracy(void) {
+	// Documented bound of real_rsqrt plus a rounding of the product.
+	real const bound = sizeof(real) < sizeof(double) ? 0x1p-20 : 0x1p-50;
+	real worst = 0;
+
+	for (int i = -40; i <= 40; i++)
+		for (int j = 1; j <= 25; j++) {
+			vec3 u = VECTOR(ldexp(1.0 + j / 7.0, i), -0.3 * j, ldexp(0.9, -i) / j);
+			tuple fast = tuple_unit_fast(u);
+			tuple* exact = VEC3_UNIT(&u);
+			for (unsigned k = 0; k < 4; k++)
+				worst = fmax(worst, fabs(fast.data[k] - exact->data[k]));
+		}
+	assert(worst <= bound);
+
+	tuple zero = tuple_unit_fast(VECTOR(0, 0, 0));
+	assert(isnan(zero.x) && isnan(zero.y) && isnan(zero.z));
+
+	putchar('.');
+}
 
 void run_vec3_tests(void) {
 	point3 p = POINT(4, -4, 3);
@@ -341,5 +418,8 @@ void run_vec3_tests(void) {
 	test_cross_null();
 	test_dot();
 	test_dot_null();
+	test_value_api_matches_pointer_api();
+	test_value_api_chains();
+	test_unit_fast_accuracy();
 }
 